@@ -0,0 +1,474 @@
+/**
+ * @file result_vs_exceptions.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Returning errors with a Result type instead of throwing them
+ * @version 0.1
+ * @date 2025-01-24
+ *
+ * The other examples of this folder report every failure by throwing, even
+ * the expected ones such as an index out of range or a subtraction below
+ * zero. Throwing is cheap when nothing fails, but each throw allocates the
+ * exception and unwinds the stack frame by frame, which is slow when errors
+ * are frequent.
+ *
+ * Result<T, E> holds either a value of type T or an error of type E, and the
+ * caller checks which one it got. The calls can be chained: andThen() and
+ * map() run the next step only if there is a value, and pass the error along
+ * otherwise, so the code reads like the throwing version.
+ *
+ * The benchmark compares both ways at several error rates and stack depths.
+ *
+ * @copyright Copyright (c) 2025
+ *
+ */
+
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Enumerated type for the errors of the examples.
+ *
+ */
+enum errorKind { RANGE_ERROR, UNDERFLOW_ERROR, OVERFLOW_ERROR };
+
+/**
+ * @brief Retrieves the message of an error.
+ *
+ * @param kind The error.
+ * @return const char* A string describing the error.
+ */
+const char *getErrorMessage(errorKind kind) {
+  switch (kind) {
+  case RANGE_ERROR:
+    return "Index out of bounds";
+  case UNDERFLOW_ERROR:
+    return "Subtraction underflow";
+  case OVERFLOW_ERROR:
+    return "Addition overflow";
+  default:
+    return "Unknown error";
+  }
+}
+
+/**
+ * @brief Error wrapper, so a Result can be built from an error even when T
+ * and E are the same type.
+ */
+template <typename E> struct Failure {
+  E error;
+};
+
+/**
+ * @brief Builds the error of a Result: return fail(RANGE_ERROR);
+ */
+template <typename E> Failure<E> fail(E error) { return Failure<E>{error}; }
+
+/**
+ * @brief Storage of a Result: a flag telling which member of the union is in
+ * use. This version is for types with their own copy, move or destructor,
+ * which it calls by hand on the member in use.
+ */
+template <typename T, typename E,
+          bool = is_trivially_copyable<T>::value &&
+                 is_trivially_copyable<E>::value>
+struct ResultStorage {
+  union {
+    T value;
+    E error;
+  };
+  bool hasValue;
+
+  ResultStorage(in_place_index_t<0>, T &&v) : value(move(v)), hasValue(true) {}
+  ResultStorage(in_place_index_t<1>, E &&e)
+      : error(move(e)), hasValue(false) {}
+
+  ResultStorage(const ResultStorage &other) : hasValue(other.hasValue) {
+    if (hasValue) {
+      new (&value) T(other.value);
+    } else {
+      new (&error) E(other.error);
+    }
+  }
+  ResultStorage(ResultStorage &&other) : hasValue(other.hasValue) {
+    if (hasValue) {
+      new (&value) T(move(other.value));
+    } else {
+      new (&error) E(move(other.error));
+    }
+  }
+
+  ResultStorage &operator=(const ResultStorage &other) {
+    if (this != &other) {
+      destroy();
+      new (this) ResultStorage(other);
+    }
+    return *this;
+  }
+  ResultStorage &operator=(ResultStorage &&other) {
+    if (this != &other) {
+      destroy();
+      new (this) ResultStorage(move(other));
+    }
+    return *this;
+  }
+
+  ~ResultStorage() { destroy(); }
+
+private:
+  void destroy() {
+    if (hasValue) {
+      value.~T();
+    } else {
+      error.~E();
+    }
+  }
+};
+
+/**
+ * @brief Storage of a Result of trivially copyable types. The copies and the
+ * destructor are the implicit ones, so the Result itself is trivially
+ * copyable and a small one, such as Result<int, errorKind>, is returned in
+ * registers.
+ */
+template <typename T, typename E> struct ResultStorage<T, E, true> {
+  union {
+    T value;
+    E error;
+  };
+  bool hasValue;
+
+  ResultStorage(in_place_index_t<0>, T &&v) : value(move(v)), hasValue(true) {}
+  ResultStorage(in_place_index_t<1>, E &&e)
+      : error(move(e)), hasValue(false) {}
+};
+
+/**
+ * @brief Either a value of type T or an error of type E.
+ *
+ * @tparam T Type of the value.
+ * @tparam E Type of the error.
+ */
+template <typename T, typename E> class Result {
+public:
+  Result(T value) : data(in_place_index<0>, move(value)) {}
+  Result(Failure<E> failure) : data(in_place_index<1>, move(failure.error)) {}
+
+  /**
+   * @brief Returns true if the Result holds a value.
+   */
+  bool ok() const { return data.hasValue; }
+  explicit operator bool() const { return ok(); }
+
+  /**
+   * @brief Returns the value.
+   *
+   * @throws std::logic_error If the Result holds an error.
+   */
+  const T &value() const & {
+    if (!ok()) {
+      throw logic_error("Result::value() called on an error");
+    }
+    return data.value;
+  }
+  T &&value() && {
+    if (!ok()) {
+      throw logic_error("Result::value() called on an error");
+    }
+    return move(data.value);
+  }
+
+  /**
+   * @brief Returns the error. The Result must hold one.
+   */
+  const E &error() const { return data.error; }
+
+  /**
+   * @brief Returns the value, or fallback if the Result holds an error.
+   */
+  T valueOr(T fallback) const & { return ok() ? data.value : fallback; }
+  T valueOr(T fallback) && {
+    return ok() ? move(data.value) : move(fallback);
+  }
+
+  /**
+   * @brief Applies f to the value and returns a Result with the value f
+   * returns. An error is passed along without calling f.
+   *
+   * The rvalue versions of map() and andThen() move the value or the error
+   * out of this Result instead of copying it.
+   */
+  template <typename F> auto map(F &&f) const & {
+    using U = decay_t<invoke_result_t<F, const T &>>;
+    if (ok()) {
+      return Result<U, E>(f(data.value));
+    }
+    return Result<U, E>(fail(data.error));
+  }
+  template <typename F> auto map(F &&f) && {
+    using U = decay_t<invoke_result_t<F, T &&>>;
+    if (ok()) {
+      return Result<U, E>(f(move(data.value)));
+    }
+    return Result<U, E>(fail(move(data.error)));
+  }
+
+  /**
+   * @brief Calls f, which returns a Result with the same error type, with the
+   * value. An error is passed along without calling f.
+   */
+  template <typename F> auto andThen(F &&f) const & {
+    using R = decay_t<invoke_result_t<F, const T &>>;
+    if (ok()) {
+      return f(data.value);
+    }
+    return R(fail(data.error));
+  }
+  template <typename F> auto andThen(F &&f) && {
+    using R = decay_t<invoke_result_t<F, T &&>>;
+    if (ok()) {
+      return f(move(data.value));
+    }
+    return R(fail(move(data.error)));
+  }
+
+  /**
+   * @brief Applies f to the error. A value is passed along without calling f.
+   */
+  template <typename F> auto mapError(F &&f) const & {
+    using G = decay_t<invoke_result_t<F, const E &>>;
+    if (ok()) {
+      return Result<T, G>(data.value);
+    }
+    return Result<T, G>(fail(f(data.error)));
+  }
+
+  /**
+   * @brief Calls f, which returns a Result with the same value type, with the
+   * error, to recover from it. A value is passed along without calling f.
+   */
+  template <typename F> Result orElse(F &&f) const & {
+    if (ok()) {
+      return *this;
+    }
+    return f(data.error);
+  }
+
+private:
+  ResultStorage<T, E> data;
+};
+
+/**
+ * @brief Returns an element of an array of 5, like
+ * testException::throwRangeError().
+ *
+ * @param index The index of the element.
+ * @return Result<int, errorKind> The element, or RANGE_ERROR.
+ */
+Result<int, errorKind> elementAt(int index) {
+  static const int arr[5] = {1, 2, 3, 4, 5};
+  if (index < 0 || index >= 5) {
+    return fail(RANGE_ERROR);
+  }
+  return arr[index];
+}
+
+/**
+ * @brief Subtracts b from a, like testException::throwUnderflowError().
+ *
+ * @return Result<int, errorKind> a - b, UNDERFLOW_ERROR if it is negative, or
+ * OVERFLOW_ERROR if it does not fit in an int.
+ */
+Result<int, errorKind> subtract(int a, int b) {
+  // Compared before subtracting, as a - b itself can overflow
+  if (a < b) {
+    return fail(UNDERFLOW_ERROR);
+  }
+  if (b < 0 && a > INT_MAX + b) {
+    return fail(OVERFLOW_ERROR);
+  }
+  return a - b;
+}
+
+/**
+ * @brief Adds a and b, like testException::throwOverflowError().
+ *
+ * @return Result<int, errorKind> a + b, or OVERFLOW_ERROR if it does not fit
+ * in an int.
+ */
+Result<int, errorKind> add(int a, int b) {
+  if ((b > 0 && a > INT_MAX - b) || (b < 0 && a < INT_MIN - b)) {
+    return fail(OVERFLOW_ERROR);
+  }
+  return a + b;
+}
+
+/**
+ * @brief Chains the checked operations: takes an element, subtracts 3 from
+ * it, adds an offset and scales the result. The first error stops the chain.
+ */
+void basicResult() {
+  for (int index : {3, 4, 6, 1}) {
+    Result<int, errorKind> result =
+        elementAt(index)
+            .andThen([](int x) { return subtract(x, 3); })
+            .andThen([](int x) { return add(x, INT_MAX - 1); })
+            .map([](int x) { return x / 2; });
+    if (result) {
+      cout << "Index " << index << ": " << result.value() << endl;
+    } else {
+      cout << "Index " << index << ": " << getErrorMessage(result.error())
+           << endl;
+    }
+  }
+
+  // Recovering from an error, and the same chain with a default value
+  Result<int, errorKind> recovered = subtract(10, 20).orElse(
+      [](errorKind) -> Result<int, errorKind> { return 0; });
+  cout << "Recovered subtraction: " << recovered.value() << endl;
+  cout << "Element 9 or -1: " << elementAt(9).valueOr(-1) << endl;
+}
+
+// The parsers of the benchmark must not be inlined or turned into loops, so
+// that each level of depth is a real call
+#ifdef _MSC_VER
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+/**
+ * @brief Counts the frames left by the parsers of the benchmark. Its
+ * destructor runs after the nested call returns, so every level has a
+ * cleanup that unwinding has to run.
+ */
+static long long framesLeft = 0;
+struct stackFrame {
+  ~stackFrame() { ++framesLeft; }
+};
+
+/**
+ * @brief Parses a value through depth nested calls, throwing from the
+ * deepest one if the value is negative.
+ *
+ * @throws std::underflow_error If value is negative.
+ */
+NOINLINE int parseThrowing(int value, int depth) {
+  stackFrame frame;
+  if (depth == 0) {
+    if (value < 0) {
+      throw underflow_error("Negative value");
+    }
+    return value;
+  }
+  return parseThrowing(value, depth - 1) + 1;
+}
+
+/**
+ * @brief Parses a value through depth nested calls, returning an error from
+ * the deepest one if the value is negative.
+ */
+NOINLINE Result<int, errorKind> parseReturning(int value, int depth) {
+  stackFrame frame;
+  if (depth == 0) {
+    if (value < 0) {
+      return fail(UNDERFLOW_ERROR);
+    }
+    return value;
+  }
+  return parseReturning(value, depth - 1).map([](int x) { return x + 1; });
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F> double timeMs(F &&f) {
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+      .count();
+}
+
+/**
+ * @brief Measures throw/catch against returning a Result, for several error
+ * rates and stack depths.
+ *
+ * @param ops Number of values parsed for each error rate and depth.
+ * @return bool True if both ways gave the same sums and error counts.
+ */
+bool benchmarkErrorPaths(size_t ops) {
+  bool same = true;
+  cout << endl << "Benchmark with " << ops << " values (ns per value)" << endl;
+  for (double errorRate : {0.0, 0.01, 0.1, 0.5}) {
+    mt19937 rng(42);
+    bernoulli_distribution isError(errorRate);
+    vector<int> values(ops);
+    for (int &value : values) {
+      value = isError(rng) ? -1 : static_cast<int>(rng() % 1000);
+    }
+
+    for (int depth : {1, 8, 32}) {
+      long long throwSum = 0, returnSum = 0;
+      size_t throwErrors = 0, returnErrors = 0;
+
+      double throwMs = timeMs([&] {
+        for (int value : values) {
+          try {
+            throwSum += parseThrowing(value, depth);
+          } catch (const underflow_error &) {
+            ++throwErrors;
+          }
+        }
+      });
+      double returnMs = timeMs([&] {
+        for (int value : values) {
+          Result<int, errorKind> result = parseReturning(value, depth);
+          if (result) {
+            returnSum += result.value();
+          } else {
+            ++returnErrors;
+          }
+        }
+      });
+
+      double n = static_cast<double>(max<size_t>(1, ops));
+      cout << "error rate " << errorRate * 100 << "%, depth " << depth
+           << ": throw " << throwMs * 1e6 / n << ", return "
+           << returnMs * 1e6 / n << endl;
+      same = same && throwSum == returnSum && throwErrors == returnErrors;
+    }
+  }
+  return same;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * Shows the chained checked operations and runs the benchmark. The number of
+ * values of the benchmark can be passed as the first argument.
+ *
+ * @return int Returns 0 if both ways of reporting errors gave the same
+ * results.
+ */
+int main(int argc, char *argv[]) {
+  basicResult();
+
+  size_t ops = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+  bool ok = benchmarkErrorPaths(ops);
+  cout << "Same results: " << (ok ? "yes" : "no") << endl;
+
+  // Wait for user to press ENTER
+  cout << "Press ENTER to exit...";
+  cin.get();
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,401 @@
+/**
+ * @file allocation_tracker.h
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Opt-in counting of heap allocations through global operator new and
+ * operator delete.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Compile a program with -DTRACK_ALLOCATIONS to replace the global allocation
+ * functions with versions that count allocations, bytes, live and peak live
+ * bytes, and a histogram of allocation sizes, per thread and per named scope.
+ * A report is printed to stderr when the process exits, and can be printed at
+ * any time with print_allocation_report().
+ *
+ * Mark the code to measure with ALLOCATION_SCOPE("name"). Allocations and
+ * deallocations are charged to the innermost scope of the thread that makes
+ * them. Without TRACK_ALLOCATIONS the macro expands to nothing and the global
+ * allocation functions are left alone.
+ *
+ * The replacement operators are defined in this header, so it must be
+ * included by only one translation unit of a program.
+ *
+ * allocation_tracker_demo.cpp checks the counters on allocations of known
+ * sizes.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef ALLOCATION_TRACKER_H
+#define ALLOCATION_TRACKER_H
+
+#ifdef TRACK_ALLOCATIONS
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+namespace alloc_tracking
+{
+constexpr size_t max_threads  = 256; // Later threads share the last slot
+constexpr size_t max_scopes   = 128; // Later scope names share the last slot
+constexpr size_t num_buckets  = 16;  // Sizes up to 8, 16, 32, ... 128 KiB, and larger
+constexpr size_t header_bytes = 16;  // Hidden header in front of every block
+
+/**
+ * @brief Counters for one thread or one scope.
+ *
+ * All members are relaxed atomics so a report can be taken while other
+ * threads keep allocating. Statics of this type are zero-initialized.
+ *
+ * live_bytes goes up in new and down in delete, but never below zero: a scope
+ * or thread that frees blocks allocated elsewhere has no live bytes, instead
+ * of a negative count that would wrap around in the peak.
+ */
+struct AllocationCounters
+{
+  std::atomic<size_t>    allocations;
+  std::atomic<size_t>    deallocations;
+  std::atomic<size_t>    bytes_allocated;
+  std::atomic<size_t>    bytes_freed;
+  std::atomic<ptrdiff_t> live_bytes;
+  std::atomic<size_t>    peak_live_bytes;
+  std::atomic<size_t>    buckets[num_buckets];
+
+  void on_allocate(size_t size)
+  {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes_allocated.fetch_add(size, std::memory_order_relaxed);
+    ptrdiff_t live = live_bytes.fetch_add(static_cast<ptrdiff_t>(size), std::memory_order_relaxed) + static_cast<ptrdiff_t>(size);
+    size_t    peak = peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > 0 && static_cast<size_t>(live) > peak &&
+           !peak_live_bytes.compare_exchange_weak(peak, static_cast<size_t>(live), std::memory_order_relaxed)) {
+    }
+    buckets[bucket(size)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void on_deallocate(size_t size)
+  {
+    deallocations.fetch_add(1, std::memory_order_relaxed);
+    bytes_freed.fetch_add(size, std::memory_order_relaxed);
+    ptrdiff_t live = live_bytes.load(std::memory_order_relaxed);
+    ptrdiff_t left = 0;
+    do {
+      left = live > static_cast<ptrdiff_t>(size) ? live - static_cast<ptrdiff_t>(size) : 0;
+    } while (!live_bytes.compare_exchange_weak(live, left, std::memory_order_relaxed));
+  }
+
+  static size_t bucket(size_t size)
+  {
+    size_t index = 0;
+    for (size_t limit = 8; size > limit && index + 1 < num_buckets; limit *= 2) {
+      ++index;
+    }
+    return index;
+  }
+};
+
+struct ScopeSlot
+{
+  const char*        name;
+  AllocationCounters counters;
+};
+
+inline AllocationCounters  process_counters;
+inline AllocationCounters  thread_counters[max_threads];
+inline std::atomic<size_t> num_threads;
+inline ScopeSlot           scopes[max_scopes];
+inline size_t              num_scopes;
+inline std::mutex          scopes_mutex;
+
+inline thread_local size_t              thread_slot   = 0;
+inline thread_local bool                thread_joined = false;
+inline thread_local AllocationCounters* current_scope = nullptr;
+
+/**
+ * @brief Returns the counters of the calling thread, claiming a slot on the
+ * thread's first allocation.
+ */
+inline AllocationCounters& this_thread_counters()
+{
+  if (!thread_joined) {
+    size_t slot   = num_threads.fetch_add(1, std::memory_order_relaxed);
+    thread_slot   = slot < max_threads ? slot : max_threads - 1;
+    thread_joined = true;
+  }
+  return thread_counters[thread_slot];
+}
+
+/**
+ * @brief Returns the counters for a scope name, registering it the first time.
+ *
+ * Names are compared by content, so the same literal used in several places
+ * refers to the same scope. The pointer is stored, so it must stay valid.
+ */
+inline AllocationCounters& scope_counters(const char* name)
+{
+  std::lock_guard<std::mutex> lock(scopes_mutex);
+  for (size_t i = 0; i < num_scopes; ++i) {
+    if (std::strcmp(scopes[i].name, name) == 0) {
+      return scopes[i].counters;
+    }
+  }
+  if (num_scopes == max_scopes) {
+    return scopes[max_scopes - 1].counters;
+  }
+  scopes[num_scopes].name = name;
+  return scopes[num_scopes++].counters;
+}
+
+/**
+ * @brief RAII marker that charges the allocations of the calling thread to a
+ * named scope while it is alive. Scopes nest; the innermost one is charged.
+ */
+class AllocationScope
+{
+public:
+  explicit AllocationScope(const char* name) : previous_(current_scope)
+  {
+    current_scope = &scope_counters(name);
+  }
+
+  AllocationScope(const AllocationScope&)            = delete;
+  AllocationScope& operator=(const AllocationScope&) = delete;
+
+  ~AllocationScope()
+  {
+    current_scope = previous_;
+  }
+
+private:
+  AllocationCounters* previous_;
+};
+
+inline void* allocate(size_t size, size_t alignment)
+{
+  // Block layout: [padding][offset to raw][user size][user data...]
+  size_t extra = alignment > header_bytes ? alignment : 0;
+  if (size > SIZE_MAX - header_bytes - extra) {
+    return nullptr;
+  }
+  char*  raw   = static_cast<char*>(std::malloc(size + header_bytes + extra));
+  if (raw == nullptr) {
+    return nullptr;
+  }
+  char* user = raw + header_bytes;
+  if (extra != 0) {
+    size_t misalignment = reinterpret_cast<uintptr_t>(user) % alignment;
+    user += misalignment == 0 ? 0 : alignment - misalignment;
+  }
+  reinterpret_cast<size_t*>(user)[-2] = static_cast<size_t>(user - raw);
+  reinterpret_cast<size_t*>(user)[-1] = size;
+
+  process_counters.on_allocate(size);
+  this_thread_counters().on_allocate(size);
+  if (current_scope != nullptr) {
+    current_scope->on_allocate(size);
+  }
+  return user;
+}
+
+inline void deallocate(void* p)
+{
+  if (p == nullptr) {
+    return;
+  }
+  char*  user   = static_cast<char*>(p);
+  size_t offset = reinterpret_cast<size_t*>(user)[-2];
+  size_t size   = reinterpret_cast<size_t*>(user)[-1];
+
+  process_counters.on_deallocate(size);
+  this_thread_counters().on_deallocate(size);
+  if (current_scope != nullptr) {
+    current_scope->on_deallocate(size);
+  }
+  std::free(user - offset);
+}
+
+/**
+ * @brief Allocation loop used by the throwing operator new overloads.
+ */
+inline void* allocate_or_throw(size_t size, size_t alignment)
+{
+  if (size == 0) {
+    size = 1;
+  }
+  while (true) {
+    if (void* p = allocate(size, alignment)) {
+      return p;
+    }
+    std::new_handler handler = std::get_new_handler();
+    if (handler == nullptr) {
+      throw std::bad_alloc();
+    }
+    handler();
+  }
+}
+
+inline void print_counters(std::FILE* out, const char* label, const AllocationCounters& counters)
+{
+  ptrdiff_t live = counters.live_bytes.load(std::memory_order_relaxed);
+  std::fprintf(out, "%-24s allocs %10zu  frees %10zu  bytes %14zu  live %12zu  peak live %12zu\n", label,
+               counters.allocations.load(std::memory_order_relaxed), counters.deallocations.load(std::memory_order_relaxed),
+               counters.bytes_allocated.load(std::memory_order_relaxed), live > 0 ? static_cast<size_t>(live) : 0,
+               counters.peak_live_bytes.load(std::memory_order_relaxed));
+}
+
+inline void print_histogram(std::FILE* out, const AllocationCounters& counters)
+{
+  std::fprintf(out, "%-24s", "  sizes");
+  size_t limit = 8;
+  for (size_t i = 0; i < num_buckets; ++i, limit *= 2) {
+    size_t count = counters.buckets[i].load(std::memory_order_relaxed);
+    if (count == 0) {
+      continue;
+    }
+    if (i + 1 < num_buckets) {
+      std::fprintf(out, " <=%zu:%zu", limit, count);
+    }
+    else {
+      std::fprintf(out, " >%zu:%zu", limit / 2, count);
+    }
+  }
+  std::fprintf(out, "\n");
+}
+} // namespace alloc_tracking
+
+/**
+ * @brief Prints the totals, then the counters of every thread and every scope.
+ *
+ * It does not allocate, so it can be called from anywhere, including while
+ * the process is exiting.
+ *
+ * @param out Stream to print to.
+ */
+inline void print_allocation_report(std::FILE* out = stderr)
+{
+  using namespace alloc_tracking;
+  std::fprintf(out, "\n==== Allocation report ====\n");
+  print_counters(out, "process", process_counters);
+  print_histogram(out, process_counters);
+
+  size_t threads = num_threads.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < threads && i < max_threads; ++i) {
+    char label[32];
+    std::snprintf(label, sizeof(label), "thread %zu", i);
+    print_counters(out, label, thread_counters[i]);
+  }
+
+  std::lock_guard<std::mutex> lock(scopes_mutex);
+  for (size_t i = 0; i < num_scopes; ++i) {
+    print_counters(out, scopes[i].name, scopes[i].counters);
+    print_histogram(out, scopes[i].counters);
+  }
+}
+
+namespace alloc_tracking
+{
+/**
+ * @brief Registers the report to be printed when the process exits.
+ */
+inline const int report_at_exit = std::atexit([] { print_allocation_report(); });
+} // namespace alloc_tracking
+
+void* operator new(size_t size)
+{
+  return alloc_tracking::allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new[](size_t size)
+{
+  return alloc_tracking::allocate_or_throw(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new(size_t size, std::align_val_t alignment)
+{
+  return alloc_tracking::allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+  return alloc_tracking::allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+  return alloc_tracking::allocate(size == 0 ? 1 : size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+  return alloc_tracking::allocate(size == 0 ? 1 : size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+  return alloc_tracking::allocate(size == 0 ? 1 : size, static_cast<size_t>(alignment));
+}
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+  return alloc_tracking::allocate(size == 0 ? 1 : size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept
+{
+  alloc_tracking::deallocate(p);
+}
+void operator delete[](void* p) noexcept
+{
+  alloc_tracking::deallocate(p);
+}
+void operator delete(void* p, size_t) noexcept
+{
+  alloc_tracking::deallocate(p);
+}
+void operator delete[](void* p, size_t) noexcept
+{
+  alloc_tracking::deallocate(p);
+}
+void operator delete(void* p, std::align_val_t) noexcept
+{
+  alloc_tracking::deallocate(p);
+}
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+  alloc_tracking::deallocate(p);
+}
+void operator delete(void* p, size_t, std::align_val_t) noexcept
+{
+  alloc_tracking::deallocate(p);
+}
+void operator delete[](void* p, size_t, std::align_val_t) noexcept
+{
+  alloc_tracking::deallocate(p);
+}
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+  alloc_tracking::deallocate(p);
+}
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+  alloc_tracking::deallocate(p);
+}
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+  alloc_tracking::deallocate(p);
+}
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept
+{
+  alloc_tracking::deallocate(p);
+}
+
+#define ALLOCATION_SCOPE_CONCAT2(a, b) a##b
+#define ALLOCATION_SCOPE_CONCAT(a, b)  ALLOCATION_SCOPE_CONCAT2(a, b)
+#define ALLOCATION_SCOPE(name)         alloc_tracking::AllocationScope ALLOCATION_SCOPE_CONCAT(allocation_scope_, __LINE__)(name)
+
+#else
+
+#define ALLOCATION_SCOPE(name) ((void)0)
+
+#endif // TRACK_ALLOCATIONS
+
+#endif // ALLOCATION_TRACKER_H
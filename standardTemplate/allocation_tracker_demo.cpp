@@ -0,0 +1,177 @@
+/**
+ * @file allocation_tracker_demo.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Checks the counters of allocation_tracker.h on known allocations.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * This program is always built with allocation tracking, whether or not
+ * -DTRACK_ALLOCATIONS is given. Each case allocates and frees blocks of known
+ * sizes inside ALLOCATION_SCOPE and compares the counters of the scope with
+ * the expected values:
+ * - a scope that allocates and frees,
+ * - a scope that only frees memory allocated before it, whose live and peak
+ *   live bytes must stay at 0 instead of wrapping around,
+ * - nested scopes, of which only the innermost one is charged,
+ * - a thread, which is counted in its own slot.
+ *
+ * Nothing is printed inside the scopes, so the stream does not add its own
+ * allocations to the counts.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef TRACK_ALLOCATIONS
+#define TRACK_ALLOCATIONS
+#endif
+#include "allocation_tracker.h"
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+
+using namespace std;
+using alloc_tracking::AllocationCounters;
+
+/**
+ * @brief Prints one counter next to its expected value.
+ *
+ * @return bool True if the counter has the expected value.
+ */
+bool check(const string& what, size_t actual, size_t expected)
+{
+  cout << "  " << what << ": " << actual;
+  if (actual == expected) {
+    cout << " (ok)" << '\n';
+  }
+  else {
+    cout << " (expected " << expected << ")" << '\n';
+  }
+  return actual == expected;
+}
+
+/**
+ * @brief Live bytes of a counter set, which the tracker keeps signed.
+ */
+size_t live_bytes(const AllocationCounters& counters)
+{
+  return static_cast<size_t>(counters.live_bytes.load());
+}
+
+/**
+ * @brief Allocates two blocks and frees them inside one scope.
+ */
+bool check_alloc_and_free()
+{
+  {
+    ALLOCATION_SCOPE("alloc_and_free");
+    void* small = ::operator new(100);
+    void* large = ::operator new(300);
+    ::operator delete(small);
+    ::operator delete(large);
+  }
+
+  const AllocationCounters& counters = alloc_tracking::scope_counters("alloc_and_free");
+  cout << "\nScope that allocates and frees" << '\n';
+  bool ok = check("allocations", counters.allocations.load(), 2);
+  ok      = check("deallocations", counters.deallocations.load(), 2) && ok;
+  ok      = check("bytes allocated", counters.bytes_allocated.load(), 400) && ok;
+  ok      = check("live bytes", live_bytes(counters), 0) && ok;
+  ok      = check("peak live bytes", counters.peak_live_bytes.load(), 400) && ok;
+  return ok;
+}
+
+/**
+ * @brief Frees, inside a scope, a block allocated before it.
+ */
+bool check_only_frees()
+{
+  void* block = ::operator new(1000);
+  {
+    ALLOCATION_SCOPE("only_frees");
+    ::operator delete(block);
+  }
+
+  const AllocationCounters& counters = alloc_tracking::scope_counters("only_frees");
+  cout << "\nScope that only frees" << '\n';
+  bool ok = check("allocations", counters.allocations.load(), 0);
+  ok      = check("deallocations", counters.deallocations.load(), 1) && ok;
+  ok      = check("live bytes", live_bytes(counters), 0) && ok;
+  ok      = check("peak live bytes", counters.peak_live_bytes.load(), 0) && ok;
+  return ok;
+}
+
+/**
+ * @brief Allocates in an outer scope and in a scope nested in it.
+ */
+bool check_nested_scopes()
+{
+  {
+    ALLOCATION_SCOPE("outer");
+    void* outer_block = ::operator new(64);
+    {
+      ALLOCATION_SCOPE("inner");
+      void* inner_block = ::operator new(32);
+      ::operator delete(inner_block);
+    }
+    ::operator delete(outer_block);
+  }
+
+  const AllocationCounters& outer = alloc_tracking::scope_counters("outer");
+  const AllocationCounters& inner = alloc_tracking::scope_counters("inner");
+  cout << "\nNested scopes" << '\n';
+  bool ok = check("outer allocations", outer.allocations.load(), 1);
+  ok      = check("outer peak live bytes", outer.peak_live_bytes.load(), 64) && ok;
+  ok      = check("inner allocations", inner.allocations.load(), 1) && ok;
+  ok      = check("inner peak live bytes", inner.peak_live_bytes.load(), 32) && ok;
+  return ok;
+}
+
+/**
+ * @brief Allocates from another thread, which gets its own counters.
+ */
+bool check_thread()
+{
+  size_t allocations = 0;
+  size_t bytes       = 0;
+  thread worker([&] {
+    {
+      ALLOCATION_SCOPE("worker");
+      for (int i = 0; i < 10; ++i) {
+        ::operator delete(::operator new(16));
+      }
+    }
+    // Read before the thread exits, as its own cleanup frees memory too
+    const AllocationCounters& counters = alloc_tracking::this_thread_counters();
+    allocations                        = counters.allocations.load();
+    bytes                              = counters.bytes_allocated.load();
+  });
+  worker.join();
+
+  const AllocationCounters& scope = alloc_tracking::scope_counters("worker");
+  cout << "\nAllocations of another thread" << '\n';
+  bool ok = check("thread allocations", allocations, 10);
+  ok      = check("thread bytes allocated", bytes, 160) && ok;
+  ok      = check("scope allocations", scope.allocations.load(), 10) && ok;
+  return ok;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * Runs every check, then prints the report of the tracker.
+ *
+ * @return int Returns 0 if every counter has the expected value.
+ */
+int main()
+{
+  bool ok = check_alloc_and_free();
+  ok      = check_only_frees() && ok;
+  ok      = check_nested_scopes() && ok;
+  ok      = check_thread() && ok;
+
+  print_allocation_report(stdout);
+  cout << "\nAll counters as expected: " << (ok ? "yes" : "no") << '\n';
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,349 @@
+/**
+ * @file batch_remove.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Removing many values from a list or a vector in a single pass.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * remove() in lists.cpp calls l.remove(number) for one value. Removing M
+ * values that way walks the whole container M times. erase_values() builds a
+ * membership set of the M values once and compacts the container in one pass,
+ * so the cost is O(n + M) instead of O(n * M).
+ *
+ * The membership set picks its layout from the values it holds:
+ * - a few values: a small array, scanned without branches;
+ * - values in a narrow range: a bitmap with one bit per value in the range;
+ * - anything else: an open addressing hash set.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <random>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Read-only set of integers, tuned for many contains() calls.
+ *
+ * @tparam T Integral type of the values.
+ */
+template <typename T>
+class MembershipSet
+{
+  static_assert(is_integral<T>::value, "MembershipSet holds integral values");
+
+public:
+  enum class Layout
+  {
+    SortedArray,
+    Bitmap,
+    HashSet
+  };
+
+  static constexpr size_t small_size     = 16;      // Up to this many values, use a sorted array
+  static constexpr size_t bits_per_value = 64;      // A bitmap may spend this many bits per value...
+  static constexpr size_t min_bitmap     = 1 << 16; // ...or this many bits in total, whichever is larger
+
+  /**
+   * @brief Builds the set. Duplicated values are allowed.
+   */
+  explicit MembershipSet(vector<T> values)
+  {
+    sort(values.begin(), values.end());
+    values.erase(unique(values.begin(), values.end()), values.end());
+    size_ = values.size();
+    if (values.empty()) {
+      layout_ = Layout::SortedArray;
+      return;
+    }
+
+    min_          = values.front();
+    uint64_t span = offset(values.back()) + 1; // Wraps to 0 only for the full range of a 64-bit type
+    if (values.size() <= small_size) {
+      layout_ = Layout::SortedArray;
+      sorted_ = move(values);
+    }
+    else if (span != 0 && span <= max<uint64_t>(min_bitmap, bits_per_value * values.size())) {
+      layout_ = Layout::Bitmap;
+      range_  = span;
+      bits_.assign((span + 63) / 64, 0);
+      for (T value : values) {
+        uint64_t bit = offset(value);
+        bits_[bit / 64] |= uint64_t(1) << (bit % 64);
+      }
+    }
+    else {
+      layout_ = Layout::HashSet;
+      size_t capacity = 16;
+      while (capacity < 2 * values.size()) {
+        capacity *= 2;
+      }
+      shift_ = 64;
+      for (size_t c = capacity; c > 1; c /= 2) {
+        --shift_;
+      }
+      slots_.resize(capacity);
+      used_.assign(capacity, 0);
+      for (T value : values) {
+        size_t slot = home(value);
+        while (used_[slot]) {
+          slot = (slot + 1) & (capacity - 1);
+        }
+        slots_[slot] = value;
+        used_[slot]  = 1;
+      }
+    }
+  }
+
+  bool contains(T value) const
+  {
+    switch (layout_) {
+    case Layout::SortedArray: {
+      // A branch-free scan beats a binary search on so few values
+      bool found = false;
+      for (T x : sorted_) {
+        found |= x == value;
+      }
+      return found;
+    }
+    case Layout::Bitmap: {
+      uint64_t bit = offset(value);
+      return bit < range_ && (bits_[bit / 64] >> (bit % 64) & 1) != 0;
+    }
+    case Layout::HashSet:
+      for (size_t slot = home(value);; slot = (slot + 1) & (slots_.size() - 1)) {
+        if (!used_[slot]) {
+          return false;
+        }
+        if (slots_[slot] == value) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  Layout layout() const
+  {
+    return layout_;
+  }
+
+  const char* layout_name() const
+  {
+    switch (layout_) {
+    case Layout::SortedArray:
+      return "sorted array";
+    case Layout::Bitmap:
+      return "bitmap";
+    case Layout::HashSet:
+      return "hash set";
+    }
+    return "";
+  }
+
+private:
+  /**
+   * @brief Distance from the smallest value, computed without overflow. Values
+   * below the smallest one wrap to large offsets, which the bitmap rejects.
+   */
+  uint64_t offset(T value) const
+  {
+    return static_cast<uint64_t>(value) - static_cast<uint64_t>(min_);
+  }
+
+  /**
+   * @brief Home slot of a value: Fibonacci hashing, the top bits of the
+   * product with 2^64 / phi.
+   */
+  size_t home(T value) const
+  {
+    return static_cast<size_t>((static_cast<uint64_t>(value) * uint64_t{0x9E3779B97F4A7C15}) >> shift_);
+  }
+
+  Layout           layout_ = Layout::SortedArray;
+  size_t           size_   = 0;
+  T                min_    = T();
+  vector<T>        sorted_;
+  uint64_t         range_ = 0;
+  vector<uint64_t> bits_;
+  vector<T>        slots_;
+  vector<char>     used_;
+  unsigned         shift_ = 0;
+};
+
+/**
+ * @brief Removes every element for which pred returns true, in one pass.
+ *
+ * @return size_t The number of elements removed.
+ */
+template <typename T, typename Predicate>
+size_t erase_where(vector<T>& v, Predicate pred)
+{
+  size_t old_size = v.size();
+  v.erase(remove_if(v.begin(), v.end(), pred), v.end());
+  return old_size - v.size();
+}
+
+template <typename T, typename Predicate>
+size_t erase_where(list<T>& l, Predicate pred)
+{
+  size_t old_size = l.size();
+  l.remove_if(pred);
+  return old_size - l.size();
+}
+
+/**
+ * @brief Removes every occurrence of any of the given values, in one pass.
+ *
+ * @param c      The list or vector to clean up.
+ * @param values The values to remove, in any order and with duplicates.
+ * @return size_t The number of elements removed.
+ */
+template <typename Container>
+size_t erase_values(Container& c, vector<typename Container::value_type> values)
+{
+  MembershipSet<typename Container::value_type> set(move(values));
+  if (set.size() == 0) {
+    return 0;
+  }
+  return erase_where(c, [&set](typename Container::value_type x) { return set.contains(x); });
+}
+
+/**
+ * @brief Prints the elements of a list, in the same format as print_list()
+ * in lists.cpp.
+ */
+void print_list(const list<int>& l)
+{
+  cout << "Lista: ";
+  for (const auto& elem : l) {
+    cout << elem << ' ';
+  }
+  cout << '\n';
+}
+
+/**
+ * @brief Removes several values from a list and a vector at once.
+ */
+void basic_batch_remove()
+{
+  list<int> l = {5, 3, 8, 1, 3, 9, 5, 2, 8};
+  print_list(l);
+  size_t removed = erase_values(l, {3, 8, 42});
+  cout << "Removed " << removed << " elements" << '\n';
+  print_list(l);
+
+  vector<int> v = {10, 11, 12, 13, 14, 15, 16};
+  removed       = erase_where(v, [](int x) { return x % 3 == 0; });
+  cout << "Removed " << removed << " multiples of 3, " << v.size() << " elements left" << '\n';
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Removes m values from a list and a vector of n elements with one
+ * remove() call per value, with erase_values() and with an unordered_set
+ * predicate, and checks that all of them agree.
+ *
+ * remove() per value is timed on at most 100 values; the time for all m values
+ * is extrapolated from it.
+ *
+ * @param n     Number of elements.
+ * @param m     Number of values to remove.
+ * @param range Elements and values are drawn from [0, range).
+ * @return bool True if every method leaves the same elements.
+ */
+bool benchmark(size_t n, size_t m, int range)
+{
+  mt19937                       rng(36);
+  uniform_int_distribution<int> dist(0, range - 1);
+  vector<int>                   data(n);
+  vector<int>                   values(m);
+  for (auto& x : data) {
+    x = dist(rng);
+  }
+  for (auto& x : values) {
+    x = dist(rng);
+  }
+
+  MembershipSet<int> probe(values);
+  cout << "\nRemoving " << m << " values in [0, " << range << ") from " << n << " elements (" << probe.layout_name() << ")" << '\n';
+
+  size_t    naive_count = min<size_t>(m, 100);
+  list<int> naive_list(data.begin(), data.end());
+  double    naive_ms = time_ms([&] {
+    for (size_t i = 0; i < naive_count; ++i) {
+      naive_list.remove(values[i]);
+    }
+  });
+  cout << "list   remove() per value:  " << naive_ms * static_cast<double>(m) / static_cast<double>(naive_count) << " ms (estimated)\n";
+
+  list<int> batch_list(data.begin(), data.end());
+  cout << "list   erase_values:        " << time_ms([&] { erase_values(batch_list, values); }) << " ms\n";
+
+  vector<int> naive_vector = data;
+  naive_ms                 = time_ms([&] {
+    for (size_t i = 0; i < naive_count; ++i) {
+      naive_vector.erase(remove(naive_vector.begin(), naive_vector.end(), values[i]), naive_vector.end());
+    }
+  });
+  cout << "vector remove() per value:  " << naive_ms * static_cast<double>(m) / static_cast<double>(naive_count) << " ms (estimated)\n";
+
+  vector<int> hashed = data;
+  cout << "vector unordered_set:       " << time_ms([&] {
+    unordered_set<int> set(values.begin(), values.end());
+    erase_where(hashed, [&set](int x) { return set.count(x) != 0; });
+  }) << " ms\n";
+
+  vector<int> batch_vector = data;
+  cout << "vector erase_values:        " << time_ms([&] { erase_values(batch_vector, values); }) << " ms\n";
+
+  return equal(batch_list.begin(), batch_list.end(), batch_vector.begin(), batch_vector.end()) && batch_vector == hashed;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of elements and of values to remove can be passed as the first
+ * and second arguments.
+ *
+ * @return int Returns 0 if every method leaves the same elements.
+ */
+int main(int argc, char* argv[])
+{
+  basic_batch_remove();
+
+  size_t n  = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+  size_t m  = argc > 2 ? strtoull(argv[2], nullptr, 10) : 5000;
+  bool   ok = true;
+  // Dense identifiers, sparse identifiers, and a handful of values
+  ok = benchmark(n, m, 200000) && ok;
+  ok = benchmark(n, m, 2000000000) && ok;
+  ok = benchmark(n, min<size_t>(m, 10), 1000) && ok;
+  cout << "Same results: " << (ok ? "yes" : "no") << '\n';
+
+  return ok ? 0 : 1;
+}
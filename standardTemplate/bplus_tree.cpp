@@ -0,0 +1,886 @@
+/**
+ * @file bplus_tree.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  B+tree of CustomKey to CustomValue with id range scans and a name
+ * prefix index.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * std::map is a red-black tree: one node per entry, so iterating over a range
+ * of ids follows a pointer to a different heap block for every entry. A
+ * B+tree keeps its entries in large leaves of about one page, sorted and
+ * linked to each other, so a range scan reads arrays one after the other.
+ * The inner nodes hold only separator keys and have dozens of children, so
+ * the tree stays only a few levels deep.
+ *
+ * CustomIndex pairs a B+tree keyed by (id, name), for id ranges, with a
+ * second one keyed by (name, id), for name prefix searches.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "custom_types.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Orders CustomKey and CustomKeyView by name and then by id.
+ */
+struct NameFirstLess
+{
+  using is_transparent = void;
+
+  template <typename A, typename B>
+  bool operator()(const A& a, const B& b) const
+  {
+    int order = string_view(a.name).compare(string_view(b.name));
+    return order != 0 ? order < 0 : a.id < b.id;
+  }
+};
+
+/**
+ * @brief Default number of entries per leaf: as many as fit in about a page.
+ */
+template <typename Key, typename Value>
+constexpr size_t bplus_leaf_capacity = max<size_t>(8, 4096 / (sizeof(Key) + sizeof(Value)));
+
+/**
+ * @brief Default number of separator keys per inner node: as many as fit,
+ * with their child pointers, in about a page.
+ */
+template <typename Key>
+constexpr size_t bplus_inner_capacity = max<size_t>(8, 4096 / (sizeof(Key) + sizeof(void*)));
+
+/**
+ * @brief Sorted map stored as a B+tree.
+ *
+ * The entries live in the leaves, which are linked in key order. Inner node
+ * i has count separator keys and count + 1 children, and separator j is not
+ * greater than any key of child j + 1 and greater than every key of child j.
+ *
+ * Leaves are not merged when they get small: a leaf is only freed when its
+ * last entry is erased. Insertions and erasures invalidate all iterators.
+ *
+ * @tparam Key           Key type.
+ * @tparam Value         Mapped type.
+ * @tparam Compare       Order of the keys. If it has is_transparent, lookups
+ *                       accept any type it can compare with Key.
+ * @tparam LeafCapacity  Maximum number of entries per leaf.
+ * @tparam InnerCapacity Maximum number of separator keys per inner node.
+ */
+template <typename Key, typename Value, typename Compare = less<Key>, size_t LeafCapacity = bplus_leaf_capacity<Key, Value>,
+          size_t InnerCapacity = bplus_inner_capacity<Key>>
+class BPlusTree
+{
+  static_assert(LeafCapacity >= 4 && InnerCapacity >= 4, "BPlusTree needs room for at least four entries per node");
+
+  /**
+   * @brief Uninitialized room for N objects of type T.
+   */
+  template <typename T, size_t N>
+  struct Slots
+  {
+    alignas(T) unsigned char storage[N * sizeof(T)];
+
+    T* data()
+    {
+      return launder(reinterpret_cast<T*>(storage));
+    }
+    T& operator[](size_t i)
+    {
+      return data()[i];
+    }
+  };
+
+  struct Node
+  {
+    bool   is_leaf;
+    size_t count = 0; // Entries of a leaf, separator keys of an inner node
+
+    explicit Node(bool leaf) : is_leaf(leaf)
+    {
+    }
+  };
+
+  // One spare slot in each node: an insertion may overflow it before it splits
+  struct Leaf : Node
+  {
+    Leaf*                          prev = nullptr;
+    Leaf*                          next = nullptr;
+    Slots<Key, LeafCapacity + 1>   keys;
+    Slots<Value, LeafCapacity + 1> values;
+
+    Leaf() : Node(true)
+    {
+    }
+    ~Leaf()
+    {
+      destroy_n(keys.data(), this->count);
+      destroy_n(values.data(), this->count);
+    }
+  };
+
+  struct Inner : Node
+  {
+    Slots<Key, InnerCapacity + 1> keys;
+    Node*                         children[InnerCapacity + 2];
+
+    Inner() : Node(false)
+    {
+    }
+    ~Inner()
+    {
+      destroy_n(keys.data(), this->count);
+    }
+  };
+
+  /**
+   * @brief One step of the way from the root to a leaf: an inner node and the
+   * child that was followed.
+   */
+  struct PathStep
+  {
+    Inner* node;
+    size_t child;
+  };
+
+  static constexpr size_t max_depth = 64; // Far more than a tree with four children per node can reach
+
+public:
+  using key_type    = Key;
+  using mapped_type = Value;
+
+  /**
+   * @brief Bidirectional iterator: a leaf and a position inside it.
+   *
+   * Dereferences to a pair<const Key&, Value&> (by value, like a proxy), so
+   * structured bindings work.
+   */
+  template <bool Const>
+  class basic_iterator
+  {
+    using Tree = conditional_t<Const, const BPlusTree, BPlusTree>;
+
+  public:
+    using iterator_category = bidirectional_iterator_tag;
+    using value_type        = pair<Key, Value>;
+    using difference_type   = ptrdiff_t;
+    using reference         = pair<const Key&, conditional_t<Const, const Value&, Value&>>;
+
+    struct pointer
+    {
+      reference ref;
+      reference* operator->()
+      {
+        return &ref;
+      }
+    };
+
+    basic_iterator() = default;
+    // An iterator converts to a const_iterator, not the other way around.
+    template <bool OtherConst, typename = enable_if_t<Const && !OtherConst>>
+    basic_iterator(const basic_iterator<OtherConst>& other) : tree_(other.tree_), leaf_(other.leaf_), index_(other.index_)
+    {
+    }
+
+    reference operator*() const
+    {
+      return {leaf_->keys[index_], leaf_->values[index_]};
+    }
+    pointer operator->() const
+    {
+      return pointer{**this};
+    }
+
+    basic_iterator& operator++()
+    {
+      if (++index_ == leaf_->count) {
+        leaf_  = leaf_->next;
+        index_ = 0;
+      }
+      return *this;
+    }
+    basic_iterator operator++(int)
+    {
+      basic_iterator old = *this;
+      ++*this;
+      return old;
+    }
+    basic_iterator& operator--()
+    {
+      if (leaf_ == nullptr) {
+        leaf_  = tree_->last_;
+        index_ = leaf_->count - 1;
+      }
+      else if (index_ == 0) {
+        leaf_  = leaf_->prev;
+        index_ = leaf_->count - 1;
+      }
+      else {
+        --index_;
+      }
+      return *this;
+    }
+    basic_iterator operator--(int)
+    {
+      basic_iterator old = *this;
+      --*this;
+      return old;
+    }
+
+    friend bool operator==(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.leaf_ == b.leaf_ && a.index_ == b.index_;
+    }
+    friend bool operator!=(const basic_iterator& a, const basic_iterator& b)
+    {
+      return !(a == b);
+    }
+
+  private:
+    friend class BPlusTree;
+    template <bool>
+    friend class basic_iterator;
+
+    basic_iterator(Tree* tree, Leaf* leaf, size_t index) : tree_(tree), leaf_(leaf), index_(index)
+    {
+      if (leaf_ != nullptr && index_ == leaf_->count) { // Past the end of a leaf: start of the next one
+        leaf_  = leaf_->next;
+        index_ = 0;
+      }
+    }
+
+    Tree*  tree_  = nullptr;
+    Leaf*  leaf_  = nullptr; // nullptr for end()
+    size_t index_ = 0;
+  };
+
+  using iterator       = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  BPlusTree() : root_(new Leaf)
+  {
+    first_ = last_ = static_cast<Leaf*>(root_);
+  }
+
+  BPlusTree(const BPlusTree&)            = delete;
+  BPlusTree& operator=(const BPlusTree&) = delete;
+
+  ~BPlusTree()
+  {
+    free_subtree(root_);
+  }
+
+  iterator begin()
+  {
+    return iterator(this, first_, 0);
+  }
+  iterator end()
+  {
+    return iterator(this, nullptr, 0);
+  }
+  const_iterator begin() const
+  {
+    return const_iterator(this, first_, 0);
+  }
+  const_iterator end() const
+  {
+    return const_iterator(this, nullptr, 0);
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  /**
+   * @brief Number of levels, leaves included.
+   */
+  size_t height() const
+  {
+    size_t levels = 1;
+    for (Node* node = root_; !node->is_leaf; node = static_cast<Inner*>(node)->children[0]) {
+      ++levels;
+    }
+    return levels;
+  }
+
+  void clear()
+  {
+    free_subtree(root_);
+    root_  = new Leaf;
+    first_ = last_ = static_cast<Leaf*>(root_);
+    size_          = 0;
+  }
+
+  /**
+   * @brief Returns the first entry whose key is not less than key.
+   */
+  template <typename K>
+  iterator lower_bound(const K& key)
+  {
+    Leaf* leaf = descend(key, false, nullptr, nullptr);
+    return iterator(this, leaf, position(leaf, key));
+  }
+
+  template <typename K>
+  const_iterator lower_bound(const K& key) const
+  {
+    return const_cast<BPlusTree*>(this)->lower_bound(key);
+  }
+
+  template <typename K>
+  iterator find(const K& key)
+  {
+    iterator it = lower_bound(key);
+    return it != end() && !comp_(key, it->first) ? it : end();
+  }
+
+  template <typename K>
+  const_iterator find(const K& key) const
+  {
+    return const_cast<BPlusTree*>(this)->find(key);
+  }
+
+  template <typename K>
+  bool contains(const K& key) const
+  {
+    return find(key) != end();
+  }
+
+  /**
+   * @brief Calls f(key, value) for every entry with lower <= key < upper, in
+   * key order, reading the leaves directly.
+   */
+  template <typename Lower, typename Upper, typename F>
+  void scan(const Lower& lower, const Upper& upper, F f) const
+  {
+    Leaf*  leaf  = descend(lower, false, nullptr, nullptr);
+    size_t index = position(leaf, lower);
+    for (; leaf != nullptr; leaf = leaf->next, index = 0) {
+      for (; index < leaf->count; ++index) {
+        if (!comp_(leaf->keys[index], upper)) {
+          return;
+        }
+        f(static_cast<const Key&>(leaf->keys[index]), static_cast<const Value&>(leaf->values[index]));
+      }
+    }
+  }
+
+  /**
+   * @return pair<iterator, bool> The entry of key, and true if it was
+   * inserted or false if its value was replaced.
+   */
+  pair<iterator, bool> insert_or_assign(const Key& key, Value value)
+  {
+    PathStep path[max_depth];
+    size_t   depth = 0;
+    Leaf*    leaf  = descend(key, true, path, &depth);
+    size_t   index = position(leaf, key);
+    if (index < leaf->count && !comp_(key, leaf->keys[index])) {
+      leaf->values[index] = move(value);
+      return {iterator(this, leaf, index), false};
+    }
+
+    insert_at(leaf->keys.data(), leaf->count, index, key);
+    insert_at(leaf->values.data(), leaf->count, index, move(value));
+    ++leaf->count;
+    ++size_;
+    if (leaf->count <= LeafCapacity) {
+      return {iterator(this, leaf, index), true};
+    }
+    Leaf* right = split_leaf(leaf, path, depth);
+    return {index < leaf->count ? iterator(this, leaf, index) : iterator(this, right, index - leaf->count), true};
+  }
+
+  /**
+   * @brief Returns the value of key, inserting a default one if needed.
+   */
+  Value& operator[](const Key& key)
+  {
+    iterator it = find(key);
+    if (it == end()) {
+      it = insert_or_assign(key, Value()).first;
+    }
+    return it->second;
+  }
+
+  template <typename K>
+  size_t erase(const K& key)
+  {
+    PathStep path[max_depth];
+    size_t   depth = 0;
+    Leaf*    leaf  = descend(key, true, path, &depth);
+    size_t   index = position(leaf, key);
+    if (index == leaf->count || comp_(key, leaf->keys[index])) {
+      return 0;
+    }
+
+    erase_at(leaf->keys.data(), leaf->count, index);
+    erase_at(leaf->values.data(), leaf->count, index);
+    --leaf->count;
+    --size_;
+    if (leaf->count == 0 && leaf != root_) {
+      remove_leaf(leaf, path, depth);
+    }
+    return 1;
+  }
+
+private:
+  /**
+   * @brief Goes from the root to the leaf where key is or would be.
+   *
+   * @param after_equal True to follow the child after a separator equal to
+   * key, which is where key is; false to follow the one before, which is
+   * where the first key not less than key is when key is not in the tree.
+   * @param path If not null, receives the steps taken, and depth their number.
+   */
+  template <typename K>
+  Leaf* descend(const K& key, bool after_equal, PathStep* path, size_t* depth) const
+  {
+    Node* node = root_;
+    while (!node->is_leaf) {
+      Inner* inner = static_cast<Inner*>(node);
+      Key*   first = inner->keys.data();
+      Key*   last  = first + inner->count;
+      size_t child = static_cast<size_t>((after_equal ? std::upper_bound(first, last, key, comp_) : std::lower_bound(first, last, key, comp_)) - first);
+      if (path != nullptr) {
+        path[(*depth)++] = {inner, child};
+      }
+      node = inner->children[child];
+    }
+    return static_cast<Leaf*>(node);
+  }
+
+  /**
+   * @brief Returns the position of the first key of leaf not less than key.
+   */
+  template <typename K>
+  size_t position(Leaf* leaf, const K& key) const
+  {
+    Key* first = leaf->keys.data();
+    return static_cast<size_t>(std::lower_bound(first, first + leaf->count, key, comp_) - first);
+  }
+
+  /**
+   * @brief Inserts value at position index of the count objects at items.
+   * The slot after them must be free.
+   */
+  template <typename T, typename U>
+  static void insert_at(T* items, size_t count, size_t index, U&& value)
+  {
+    if (index == count) {
+      new (items + count) T(forward<U>(value));
+      return;
+    }
+    new (items + count) T(move(items[count - 1]));
+    move_backward(items + index, items + count - 1, items + count);
+    items[index] = forward<U>(value);
+  }
+
+  /**
+   * @brief Removes the object at position index of the count objects at
+   * items.
+   */
+  template <typename T>
+  static void erase_at(T* items, size_t count, size_t index)
+  {
+    move(items + index + 1, items + count, items + index);
+    items[count - 1].~T();
+  }
+
+  /**
+   * @brief Moves count objects from from into the free slots at to.
+   */
+  template <typename T>
+  static void relocate(T* from, size_t count, T* to)
+  {
+    uninitialized_move_n(from, count, to);
+    destroy_n(from, count);
+  }
+
+  /**
+   * @brief Moves the upper half of an overflowing leaf to a new leaf after
+   * it, and adds the new leaf to the parent.
+   *
+   * @return Leaf* The new leaf.
+   */
+  Leaf* split_leaf(Leaf* leaf, PathStep* path, size_t depth)
+  {
+    Leaf*  right = new Leaf;
+    size_t half  = leaf->count / 2;
+    relocate(leaf->keys.data() + half, leaf->count - half, right->keys.data());
+    relocate(leaf->values.data() + half, leaf->count - half, right->values.data());
+    right->count = leaf->count - half;
+    leaf->count  = half;
+
+    right->prev = leaf;
+    right->next = leaf->next;
+    if (leaf->next != nullptr) {
+      leaf->next->prev = right;
+    }
+    else {
+      last_ = right;
+    }
+    leaf->next = right;
+
+    insert_child(leaf, Key(right->keys[0]), right, path, depth);
+    return right;
+  }
+
+  /**
+   * @brief Adds right, the new node after left, to the parent of left, which
+   * is the last step of path. Splits the parent in turn if it overflows, up
+   * to the root.
+   */
+  void insert_child(Node* left, Key separator, Node* right, PathStep* path, size_t depth)
+  {
+    while (depth > 0) {
+      PathStep step   = path[--depth];
+      Inner*   parent = step.node;
+      insert_at(parent->keys.data(), parent->count, step.child, move(separator));
+      move_backward(parent->children + step.child + 1, parent->children + parent->count + 1, parent->children + parent->count + 2);
+      parent->children[step.child + 1] = right;
+      if (++parent->count <= InnerCapacity) {
+        return;
+      }
+
+      // The middle separator moves up; the ones after it go to the new node
+      Inner* sibling = new Inner;
+      size_t middle  = parent->count / 2;
+      separator      = move(parent->keys[middle]);
+      relocate(parent->keys.data() + middle + 1, parent->count - middle - 1, sibling->keys.data());
+      copy(parent->children + middle + 1, parent->children + parent->count + 1, sibling->children);
+      parent->keys[middle].~Key();
+      sibling->count = parent->count - middle - 1;
+      parent->count  = middle;
+      left           = parent;
+      right          = sibling;
+    }
+
+    Inner* root = new Inner;
+    new (root->keys.data()) Key(move(separator));
+    root->children[0] = left;
+    root->children[1] = right;
+    root->count       = 1;
+    root_             = root;
+  }
+
+  /**
+   * @brief Frees an empty leaf and removes it from its parent, freeing the
+   * parents left without children too.
+   */
+  void remove_leaf(Leaf* leaf, PathStep* path, size_t depth)
+  {
+    (leaf->prev != nullptr ? leaf->prev->next : first_) = leaf->next;
+    (leaf->next != nullptr ? leaf->next->prev : last_)  = leaf->prev;
+    delete leaf;
+
+    while (depth > 0) {
+      PathStep step   = path[--depth];
+      Inner*   parent = step.node;
+      if (parent->count == 0) { // Its only child is gone
+        delete parent;
+        continue;
+      }
+      // The separator before the child goes with it; for the first child,
+      // the one after it
+      erase_at(parent->keys.data(), parent->count, step.child == 0 ? 0 : step.child - 1);
+      move(parent->children + step.child + 1, parent->children + parent->count + 1, parent->children + step.child);
+      --parent->count;
+
+      while (!root_->is_leaf && root_->count == 0) { // A root with one child is not needed
+        Inner* old = static_cast<Inner*>(root_);
+        root_      = old->children[0];
+        delete old;
+      }
+      return;
+    }
+
+    // Every node on the path was freed: the tree is empty
+    root_  = new Leaf;
+    first_ = last_ = static_cast<Leaf*>(root_);
+  }
+
+  static void free_subtree(Node* node)
+  {
+    if (node->is_leaf) {
+      delete static_cast<Leaf*>(node);
+      return;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    for (size_t i = 0; i <= inner->count; ++i) {
+      free_subtree(inner->children[i]);
+    }
+    delete inner;
+  }
+
+  Node*   root_;
+  Leaf*   first_;
+  Leaf*   last_;
+  size_t  size_ = 0;
+  Compare comp_;
+};
+
+/**
+ * @brief Empty mapped type, for trees used as sets.
+ */
+struct NoValue
+{
+};
+
+/**
+ * @brief The entries of maps.cpp in a B+tree by (id, name), plus a B+tree of
+ * the keys by (name, id) for name prefix searches.
+ */
+class CustomIndex
+{
+  /**
+   * @brief Upper bound of an id range: it comes after every key with an id up
+   * to id.
+   */
+  struct IdAbove
+  {
+    int id;
+  };
+
+  struct RangeLess : CustomKeyLess
+  {
+    using CustomKeyLess::operator();
+
+    bool operator()(const CustomKey& key, const IdAbove& bound) const
+    {
+      return key.id <= bound.id;
+    }
+  };
+
+public:
+  using Tree = BPlusTree<CustomKey, CustomValue, RangeLess>;
+
+  const Tree& entries() const
+  {
+    return entries_;
+  }
+
+  void insert_or_assign(const CustomKey& key, CustomValue value)
+  {
+    if (entries_.insert_or_assign(key, move(value)).second) {
+      by_name_.insert_or_assign(key, NoValue());
+    }
+  }
+
+  const CustomValue* find(int id, string_view name) const
+  {
+    auto it = entries_.find(CustomKeyView{id, name});
+    return it == entries_.end() ? nullptr : &it->second;
+  }
+
+  bool erase(int id, string_view name)
+  {
+    by_name_.erase(CustomKeyView{id, name});
+    return entries_.erase(CustomKeyView{id, name}) != 0;
+  }
+
+  /**
+   * @brief Calls f(key, value) for every entry with first_id <= id <=
+   * last_id, in key order.
+   */
+  template <typename F>
+  void for_each_in_id_range(int first_id, int last_id, F f) const
+  {
+    entries_.scan(CustomKeyView{first_id, ""}, IdAbove{last_id}, f);
+  }
+
+  /**
+   * @brief Calls f(key, value) for every entry whose name starts with prefix,
+   * in name order.
+   */
+  template <typename F>
+  void for_each_with_name_prefix(string_view prefix, F f) const
+  {
+    for (auto it = by_name_.lower_bound(CustomKeyView{INT_MIN, prefix}); it != by_name_.end(); ++it) {
+      const CustomKey& key = it->first;
+      if (key.name.compare(0, prefix.size(), prefix) != 0) {
+        break;
+      }
+      f(key, *find(key.id, key.name));
+    }
+  }
+
+private:
+  Tree                                         entries_;
+  BPlusTree<CustomKey, NoValue, NameFirstLess> by_name_;
+};
+
+/**
+ * @brief Prints one entry, in the same format as print_map() in maps.cpp.
+ */
+void print_entry(const CustomKey& key, const CustomValue& value)
+{
+  cout << "Name: " << key.name << " ID(" << key.id << ") -> Age: " << value.age << ", Address: " << value.address << '\n';
+}
+
+/**
+ * @brief Same operations as the menu of maps.cpp, plus an id range and a
+ * name prefix search.
+ */
+void basic_bplus_tree()
+{
+  CustomIndex index;
+  // Predefine
+  index.insert_or_assign(CustomKey(1, "Alice"), CustomValue(25, "123 Main St"));
+  index.insert_or_assign(CustomKey(2, "Bob"), CustomValue(30, "456 Elm St"));
+  index.insert_or_assign(CustomKey(3, "Charlie"), CustomValue(35, "789 Oak St"));
+  index.insert_or_assign(CustomKey(4, "Alberto"), CustomValue(41, "1 Pine St"));
+  for (const auto& [key, value] : index.entries()) {
+    print_entry(key, value);
+  }
+
+  cout << "IDs 2 to 3:\n";
+  index.for_each_in_id_range(2, 3, print_entry);
+  cout << "Names starting with \"Al\":\n";
+  index.for_each_with_name_prefix("Al", print_entry);
+
+  index.erase(1, "Alice");
+  cout << "Names starting with \"Al\" after removing Alice:\n";
+  index.for_each_with_name_prefix("Al", print_entry);
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Compares the B+tree with std::map on insertions, lookups, id range
+ * scans and name prefix searches, and checks that both hold the same entries
+ * after erasing a part of them.
+ *
+ * @param n     Number of entries.
+ * @param width Number of ids of each range scan.
+ * @return bool True if every result matched.
+ */
+bool benchmark(size_t n, int width)
+{
+  mt19937           rng(42);
+  size_t            max_id = n / 2 + 1;
+  vector<CustomKey> keys;
+  for (size_t i = 0; i < n; ++i) {
+    keys.emplace_back(static_cast<int>(rng() % max_id), "name-" + to_string(rng() % 20000));
+  }
+
+  cout << "\nBenchmark with " << n << " entries" << '\n';
+
+  map<CustomKey, CustomValue> reference;
+  CustomIndex                 index;
+  cout << "insert   std::map: " << time_ms([&] {
+    for (const auto& key : keys) {
+      reference.insert_or_assign(key, CustomValue(key.id % 100, "Street"));
+    }
+  }) << " ms, CustomIndex (both trees): " << time_ms([&] {
+    for (const auto& key : keys) {
+      index.insert_or_assign(key, CustomValue(key.id % 100, "Street"));
+    }
+  }) << " ms (height " << index.entries().height() << ")\n";
+
+  long long map_sum = 0, tree_sum = 0;
+  cout << "find     std::map: " << time_ms([&] {
+    for (const auto& key : keys) {
+      map_sum += reference.find(key)->second.age;
+    }
+  }) << " ms, B+tree: " << time_ms([&] {
+    for (const auto& key : keys) {
+      const CustomValue* value = index.find(key.id, key.name);
+      tree_sum += value != nullptr ? value->age : 0;
+    }
+  }) << " ms\n";
+
+  vector<int> starts;
+  for (int i = 0; i < 10000; ++i) {
+    starts.push_back(static_cast<int>(rng() % max_id));
+  }
+  cout << "id range std::map: " << time_ms([&] {
+    for (int first : starts) {
+      for (auto it = reference.lower_bound(CustomKey(first, "")); it != reference.end() && it->first.id < first + width; ++it) {
+        map_sum += it->second.age;
+      }
+    }
+  }) << " ms, B+tree: " << time_ms([&] {
+    for (int first : starts) {
+      index.for_each_in_id_range(first, first + width - 1, [&](const CustomKey&, const CustomValue& value) { tree_sum += value.age; });
+    }
+  }) << " ms (" << starts.size() << " ranges of " << width << " ids)\n";
+
+  size_t map_matches = 0, tree_matches = 0;
+  cout << "prefix   std::map full scan: " << time_ms([&] {
+    for (int i = 0; i < 20; ++i) {
+      string prefix = "name-" + to_string(i + 1) + "9";
+      for (const auto& entry : reference) {
+        map_matches += entry.first.name.compare(0, prefix.size(), prefix) == 0;
+      }
+    }
+  }) << " ms, name index: " << time_ms([&] {
+    for (int i = 0; i < 20; ++i) {
+      index.for_each_with_name_prefix("name-" + to_string(i + 1) + "9", [&](const CustomKey&, const CustomValue&) { ++tree_matches; });
+    }
+  }) << " ms (20 prefixes)\n";
+
+  for (size_t i = 0; i < keys.size(); i += 2) {
+    reference.erase(keys[i]);
+    index.erase(keys[i].id, keys[i].name);
+  }
+  bool same = map_sum == tree_sum && map_matches == tree_matches && reference.size() == index.entries().size();
+  auto it   = reference.begin();
+  for (const auto& [key, value] : index.entries()) {
+    same = same && it != reference.end() && key.id == it->first.id && key.name == it->first.name && value.age == it->second.age;
+    ++it;
+  }
+  return same;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of entries and the number of ids of each range scan can be
+ * passed as the first and second arguments.
+ *
+ * @return int Returns 0 if the B+tree and std::map gave the same results.
+ */
+int main(int argc, char* argv[])
+{
+  basic_bplus_tree();
+
+  size_t n     = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+  int    width = argc > 2 ? atoi(argv[2]) : 100;
+  bool   ok    = benchmark(n, max(1, width));
+  cout << "Same results: " << (ok ? "yes" : "no") << '\n';
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,579 @@
+/**
+ * @file clock_cache.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Fixed-size cache of CustomKey to CustomValue with CLOCK eviction,
+ * in front of the map of maps.cpp.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * When only a small part of a large map is used often, a cache with a fixed
+ * number of entries keeps that part close at hand and bounds the memory.
+ * When it is full, a new entry replaces one that has not been used lately.
+ *
+ * Exact LRU moves an entry to the front of a list on every hit. CLOCK gets
+ * almost the same hit rate with less work per hit. The entries sit in a ring
+ * with a "referenced" bit each, and a hit only sets the bit. To make room,
+ * a hand sweeps the ring: it clears the bit of each referenced entry it
+ * passes (a second chance) and evicts the first entry whose bit is clear.
+ *
+ * Misses can go to a loader, a function that fetches the value from the
+ * slower store behind the cache. ShardedClockCache splits the keys among
+ * several caches with a mutex each, for use from many threads.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "custom_types.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Counters of a cache.
+ */
+struct CacheStats
+{
+  uint64_t hits      = 0;
+  uint64_t misses    = 0;
+  uint64_t evictions = 0;
+
+  double hit_rate() const
+  {
+    return hits + misses == 0 ? 0 : static_cast<double>(hits) / static_cast<double>(hits + misses);
+  }
+
+  CacheStats& operator+=(const CacheStats& other)
+  {
+    hits += other.hits;
+    misses += other.misses;
+    evictions += other.evictions;
+    return *this;
+  }
+};
+
+/**
+ * @brief Cache of at most capacity entries, with CLOCK eviction.
+ *
+ * Lookups go through a hash table. Each entry also has a position in the
+ * ring, which the hand sweeps when it needs room. A new entry starts with
+ * its bit clear, so entries used only once leave before the ones hit again.
+ *
+ * @tparam Key   Key type.
+ * @tparam Value Cached type.
+ * @tparam Hash  Hash of the keys.
+ * @tparam Equal Equality of the keys.
+ */
+template <typename Key, typename Value, typename Hash = hash<Key>, typename Equal = equal_to<Key>>
+class ClockCache
+{
+  struct Entry
+  {
+    Value  value;
+    size_t slot;               // Position in ring_
+    bool   referenced = false; // Set by a hit, cleared by the hand
+  };
+
+  using Table = unordered_map<Key, Entry, Hash, Equal>;
+
+public:
+  /**
+   * @param capacity Maximum number of entries, at least 1.
+   */
+  explicit ClockCache(size_t capacity) : capacity_(max<size_t>(1, capacity))
+  {
+    table_.reserve(capacity_); // The table never grows past capacity_, so it never rehashes
+    ring_.reserve(capacity_);
+  }
+
+  size_t size() const
+  {
+    return ring_.size();
+  }
+
+  size_t capacity() const
+  {
+    return capacity_;
+  }
+
+  const CacheStats& stats() const
+  {
+    return stats_;
+  }
+
+  /**
+   * @brief Returns the cached value of key, or nullptr. The pointer is valid
+   * until the cache changes.
+   */
+  Value* get(const Key& key)
+  {
+    auto it = table_.find(key);
+    if (it == table_.end()) {
+      ++stats_.misses;
+      return nullptr;
+    }
+    ++stats_.hits;
+    it->second.referenced = true;
+    return &it->second.value;
+  }
+
+  /**
+   * @brief Returns the cached value of key. On a miss, calls loader(key),
+   * which returns an optional<Value>, and caches the value it returns.
+   *
+   * @return Value* The value, or nullptr if the loader found none.
+   */
+  template <typename Loader>
+  Value* get_or_load(const Key& key, Loader&& loader)
+  {
+    if (Value* value = get(key)) {
+      return value;
+    }
+    optional<Value> loaded = loader(key);
+    return loaded ? &put(key, move(*loaded)) : nullptr;
+  }
+
+  /**
+   * @brief Caches value for key, evicting an entry if the cache is full.
+   *
+   * @return Value& The cached value.
+   */
+  Value& put(const Key& key, Value value)
+  {
+    auto it = table_.find(key);
+    if (it != table_.end()) {
+      it->second.value      = move(value);
+      it->second.referenced = true;
+      return it->second.value;
+    }
+
+    size_t slot = ring_.size();
+    if (slot == capacity_) {
+      slot = evict();
+    }
+    auto* entry = &*table_.emplace(key, Entry{move(value), slot}).first;
+    if (slot == ring_.size()) {
+      ring_.push_back(entry);
+    }
+    else {
+      ring_[slot] = entry;
+    }
+    return entry->second.value;
+  }
+
+  bool erase(const Key& key)
+  {
+    auto it = table_.find(key);
+    if (it == table_.end()) {
+      return false;
+    }
+    // The last entry of the ring fills the hole
+    size_t slot = it->second.slot;
+    ring_[slot] = ring_.back();
+    ring_[slot]->second.slot = slot;
+    ring_.pop_back();
+    table_.erase(it);
+    if (hand_ >= ring_.size()) {
+      hand_ = 0;
+    }
+    return true;
+  }
+
+  void clear()
+  {
+    table_.clear();
+    ring_.clear();
+    hand_ = 0;
+  }
+
+private:
+  /**
+   * @brief Sweeps the ring from the hand, giving a second chance to the
+   * referenced entries, and removes the first entry that is not.
+   *
+   * @return size_t The slot of the ring that became free.
+   */
+  size_t evict()
+  {
+    while (ring_[hand_]->second.referenced) {
+      ring_[hand_]->second.referenced = false;
+      hand_                           = (hand_ + 1) % ring_.size();
+    }
+    size_t slot = hand_;
+    table_.erase(ring_[slot]->first);
+    hand_ = (hand_ + 1) % ring_.size();
+    ++stats_.evictions;
+    return slot;
+  }
+
+  size_t                              capacity_;
+  Table                               table_;
+  vector<typename Table::value_type*> ring_; // Entries in clock order
+  size_t                              hand_ = 0;
+  CacheStats                          stats_;
+};
+
+/**
+ * @brief ClockCache split into shards, each with a mutex, for many threads.
+ *
+ * A loader runs without any lock held, so a slow store does not block the
+ * other threads. Two threads that miss the same key at the same time may
+ * both load it.
+ */
+template <typename Key, typename Value, typename Hash = hash<Key>, typename Equal = equal_to<Key>>
+class ShardedClockCache
+{
+public:
+  /**
+   * @param capacity Total number of entries, divided among the shards.
+   * @param shards   Number of shards.
+   */
+  ShardedClockCache(size_t capacity, size_t shards = 4 * max(1u, thread::hardware_concurrency()))
+  {
+    shards = max<size_t>(1, min(shards, capacity));
+    for (size_t s = 0; s < shards; ++s) {
+      shards_.push_back(make_unique<Shard>(capacity / shards + (s < capacity % shards ? 1 : 0)));
+    }
+  }
+
+  /**
+   * @brief Returns a copy of the cached value of key, loading it with
+   * loader(key) on a miss.
+   */
+  template <typename Loader>
+  optional<Value> get_or_load(const Key& key, Loader&& loader)
+  {
+    Shard& shard = shard_of(key);
+    {
+      lock_guard<mutex> lock(shard.entries_mutex);
+      if (Value* value = shard.cache.get(key)) {
+        return *value;
+      }
+    }
+    optional<Value> loaded = loader(key);
+    if (loaded) {
+      lock_guard<mutex> lock(shard.entries_mutex);
+      shard.cache.put(key, *loaded);
+    }
+    return loaded;
+  }
+
+  void put(const Key& key, Value value)
+  {
+    Shard&            shard = shard_of(key);
+    lock_guard<mutex> lock(shard.entries_mutex);
+    shard.cache.put(key, move(value));
+  }
+
+  bool erase(const Key& key)
+  {
+    Shard&            shard = shard_of(key);
+    lock_guard<mutex> lock(shard.entries_mutex);
+    return shard.cache.erase(key);
+  }
+
+  size_t size() const
+  {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+      lock_guard<mutex> lock(shard->entries_mutex);
+      total += shard->cache.size();
+    }
+    return total;
+  }
+
+  CacheStats stats() const
+  {
+    CacheStats total;
+    for (const auto& shard : shards_) {
+      lock_guard<mutex> lock(shard->entries_mutex);
+      total += shard->cache.stats();
+    }
+    return total;
+  }
+
+private:
+  struct alignas(64) Shard
+  {
+    explicit Shard(size_t capacity) : cache(capacity)
+    {
+    }
+
+    mutable mutex                       entries_mutex;
+    ClockCache<Key, Value, Hash, Equal> cache;
+  };
+
+  Shard& shard_of(const Key& key)
+  {
+    return *shards_[(uint64_t(Hash()(key)) * 0x9E3779B97F4A7C15ull >> 32) % shards_.size()];
+  }
+
+  vector<unique_ptr<Shard>> shards_;
+};
+
+/**
+ * @brief Cache with exact LRU eviction: a list in order of use and a hash
+ * table into it. Used as the reference in the benchmark.
+ */
+template <typename Key, typename Value, typename Hash, typename Equal>
+class LruCache
+{
+public:
+  explicit LruCache(size_t capacity) : capacity_(max<size_t>(1, capacity))
+  {
+    table_.reserve(capacity_);
+  }
+
+  const CacheStats& stats() const
+  {
+    return stats_;
+  }
+
+  template <typename Loader>
+  Value* get_or_load(const Key& key, Loader&& loader)
+  {
+    auto it = table_.find(key);
+    if (it != table_.end()) {
+      ++stats_.hits;
+      order_.splice(order_.begin(), order_, it->second); // Most recently used first
+      return &it->second->second;
+    }
+    ++stats_.misses;
+    optional<Value> loaded = loader(key);
+    if (!loaded) {
+      return nullptr;
+    }
+    if (order_.size() == capacity_) {
+      table_.erase(order_.back().first);
+      order_.pop_back();
+      ++stats_.evictions;
+    }
+    order_.emplace_front(key, move(*loaded));
+    table_.emplace(key, order_.begin());
+    return &order_.front().second;
+  }
+
+private:
+  using Order = list<pair<Key, Value>>;
+
+  size_t                                                    capacity_;
+  Order                                                     order_;
+  unordered_map<Key, typename Order::iterator, Hash, Equal> table_;
+  CacheStats                                                stats_;
+};
+
+using CustomCache        = ClockCache<CustomKey, CustomValue, CustomKeyHash, CustomKeyEqual>;
+using CustomShardedCache = ShardedClockCache<CustomKey, CustomValue, CustomKeyHash, CustomKeyEqual>;
+
+/**
+ * @brief Loader that reads the store behind the cache: a map like the one of
+ * maps.cpp.
+ */
+struct MapLoader
+{
+  const map<CustomKey, CustomValue>* store;
+  size_t                             loads = 0;
+
+  optional<CustomValue> operator()(const CustomKey& key)
+  {
+    ++loads;
+    auto it = store->find(key);
+    if (it == store->end()) {
+      return nullopt;
+    }
+    return it->second;
+  }
+};
+
+/**
+ * @brief Prints the counters of a cache.
+ */
+void print_stats(const CacheStats& stats)
+{
+  cout << "hits " << stats.hits << ", misses " << stats.misses << ", evictions " << stats.evictions << ", hit rate " << stats.hit_rate() * 100 << "%\n";
+}
+
+/**
+ * @brief A cache of two entries in front of the predefined map of maps.cpp.
+ */
+void basic_clock_cache()
+{
+  map<CustomKey, CustomValue> store;
+  // Predefine
+  store[CustomKey(1, "Alice")]   = CustomValue(25, "123 Main St");
+  store[CustomKey(2, "Bob")]     = CustomValue(30, "456 Elm St");
+  store[CustomKey(3, "Charlie")] = CustomValue(35, "789 Oak St");
+
+  CustomCache cache(2);
+  MapLoader   loader{&store};
+  for (const CustomKey& key : {CustomKey(1, "Alice"), CustomKey(2, "Bob"), CustomKey(1, "Alice"), CustomKey(3, "Charlie"), CustomKey(1, "Alice"),
+                               CustomKey(2, "Bob"), CustomKey(4, "Dave")}) {
+    CustomValue* value = cache.get_or_load(key, loader);
+    cout << "Name: " << key.name << " ID(" << key.id << ") -> ";
+    if (value != nullptr) {
+      cout << "Age: " << value->age << ", Address: " << value->address << '\n';
+    }
+    else {
+      cout << "Key not found" << '\n';
+    }
+  }
+  print_stats(cache.stats());
+}
+
+/**
+ * @brief Ranks from 0 to n - 1 drawn with a Zipf distribution: rank r comes
+ * up in proportion to 1 / (r + 1)^skew, so a few keys take most accesses.
+ */
+class ZipfDistribution
+{
+public:
+  ZipfDistribution(size_t n, double skew) : cumulative_(n)
+  {
+    double sum = 0;
+    for (size_t r = 0; r < n; ++r) {
+      sum += 1 / pow(static_cast<double>(r + 1), skew);
+      cumulative_[r] = sum;
+    }
+  }
+
+  template <typename Rng>
+  size_t operator()(Rng& rng)
+  {
+    double u = uniform_real_distribution<double>(0, cumulative_.back())(rng);
+    return min(static_cast<size_t>(lower_bound(cumulative_.begin(), cumulative_.end(), u) - cumulative_.begin()), cumulative_.size() - 1);
+  }
+
+private:
+  vector<double> cumulative_;
+};
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Compares CLOCK with exact LRU for several cache sizes, then runs the
+ * sharded cache from several threads.
+ *
+ * @param n   Number of entries of the store.
+ * @param ops Number of accesses, with a Zipf distribution over the keys.
+ * @return bool True if every value read through a cache matched the store.
+ */
+bool benchmark(size_t n, size_t ops)
+{
+  map<CustomKey, CustomValue> store;
+  vector<CustomKey>           keys;
+  for (size_t i = 0; i < n; ++i) {
+    keys.emplace_back(static_cast<int>(i), "name-" + to_string(i % 1000));
+    store.emplace(keys.back(), CustomValue(static_cast<int>(i % 100), "Street " + to_string(i)));
+  }
+  shuffle(keys.begin(), keys.end(), mt19937(7)); // The hot keys are spread over the map
+
+  ZipfDistribution zipf(n, 0.99);
+  mt19937          rng(42);
+  vector<size_t>   accesses(ops);
+  for (auto& rank : accesses) {
+    rank = zipf(rng);
+  }
+
+  cout << "\nBenchmark with " << n << " entries and " << ops << " accesses" << '\n';
+  bool      same    = true;
+  long long map_sum = 0;
+  cout << "store only: " << time_ms([&] {
+    for (size_t rank : accesses) {
+      map_sum += store.find(keys[rank])->second.age;
+    }
+  }) << " ms\n";
+
+  for (double fraction : {0.01, 0.05, 0.2}) {
+    size_t                                                          capacity = max<size_t>(1, static_cast<size_t>(static_cast<double>(n) * fraction));
+    CustomCache                                                     clock(capacity);
+    LruCache<CustomKey, CustomValue, CustomKeyHash, CustomKeyEqual> lru(capacity);
+    MapLoader                                                       loader{&store};
+    long long                                                       clock_sum = 0, lru_sum = 0;
+
+    cout << "capacity " << fraction * 100 << "%: CLOCK " << time_ms([&] {
+      for (size_t rank : accesses) {
+        clock_sum += clock.get_or_load(keys[rank], loader)->age;
+      }
+    }) << " ms, hit rate " << clock.stats().hit_rate() * 100 << "%; LRU " << time_ms([&] {
+      for (size_t rank : accesses) {
+        lru_sum += lru.get_or_load(keys[rank], loader)->age;
+      }
+    }) << " ms, hit rate " << lru.stats().hit_rate() * 100 << "%\n";
+    same = same && clock_sum == map_sum && lru_sum == map_sum && clock.size() <= capacity;
+  }
+
+  cout << "Sharded cache, capacity 5%:" << '\n';
+  for (unsigned num_threads : {1u, 2u, 4u, 8u}) {
+    CustomShardedCache cache(max<size_t>(1, n / 20));
+    vector<thread>     threads;
+    atomic<bool>       values_ok{true};
+    double             ms = time_ms([&] {
+      for (unsigned t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+          MapLoader loader{&store};
+          for (size_t i = t; i < accesses.size(); i += num_threads) {
+            const CustomKey& key   = keys[accesses[i]];
+            auto             value = cache.get_or_load(key, loader);
+            if (!value || value->address != "Street " + to_string(key.id)) {
+              values_ok = false;
+            }
+          }
+        });
+      }
+      for (auto& th : threads) {
+        th.join();
+      }
+    });
+    cout << num_threads << " threads: " << ms << " ms, ";
+    print_stats(cache.stats());
+    same = same && values_ok && cache.size() <= max<size_t>(1, n / 20);
+  }
+  return same;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of entries of the store and of accesses can be passed as the
+ * first and second arguments.
+ *
+ * @return int Returns 0 if every value read through a cache was right.
+ */
+int main(int argc, char* argv[])
+{
+  basic_clock_cache();
+
+  size_t n   = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+  size_t ops = argc > 2 ? strtoull(argv[2], nullptr, 10) : 4000000;
+  bool   ok  = benchmark(max<size_t>(1, n), ops);
+  cout << "Same results: " << (ok ? "yes" : "no") << '\n';
+
+  return ok ? 0 : 1;
+}
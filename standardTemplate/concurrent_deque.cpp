@@ -0,0 +1,707 @@
+/**
+ * @file concurrent_deque.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Lock-free double-ended queue for many threads, with epoch-based
+ * memory reclamation.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * The lists of lists.cpp are used by one thread. Sharing a std::list between
+ * producer and consumer threads needs a mutex around every push and pop, and
+ * every thread then waits on that mutex. ConcurrentDeque lets any number of
+ * threads push and pop at both ends without locks.
+ *
+ * The algorithm is the CAS-based deque of M. M. Michael (2003). The two ends
+ * of the deque and a status live in a single 64-bit anchor, so one
+ * compare-and-swap changes the deque. A push first swings the anchor to the new
+ * node and marks the anchor unstable. Then it links the old end node to the new
+ * one. Any thread that finds the anchor unstable finishes that step first, so
+ * no thread ever waits for another one.
+ *
+ * The ends fit in 64 bits because nodes are referred to by 31-bit indices
+ * into segments that are only freed with the deque. A popped node is retired,
+ * and its index is reused only when no thread can still be reading it (an
+ * epoch-based grace period).
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+constexpr size_t max_threads = 128; // Threads that can use the concurrent deques at the same time
+
+/**
+ * @brief Returns a number in [0, max_threads) that no other running thread
+ * holds. The number is released when the thread exits.
+ *
+ * @throws std::runtime_error if more than max_threads threads ask for one.
+ */
+size_t thread_slot()
+{
+  struct Slot
+  {
+    static mutex& registry_mutex()
+    {
+      static mutex m;
+      return m;
+    }
+    static vector<bool>& taken()
+    {
+      static vector<bool> t(max_threads, false);
+      return t;
+    }
+
+    Slot()
+    {
+      lock_guard<mutex> lock(registry_mutex());
+      auto              it = find(taken().begin(), taken().end(), false);
+      if (it == taken().end()) {
+        throw runtime_error("thread_slot: too many threads");
+      }
+      *it   = true;
+      index = static_cast<size_t>(it - taken().begin());
+    }
+    ~Slot()
+    {
+      lock_guard<mutex> lock(registry_mutex());
+      taken()[index] = false;
+    }
+
+    size_t index = 0;
+  };
+
+  thread_local Slot slot;
+  return slot.index;
+}
+
+/**
+ * @brief Lock-free deque with push and pop at both ends.
+ *
+ * @tparam T Type of the elements. It must be move constructible.
+ */
+template <typename T>
+class ConcurrentDeque
+{
+public:
+  ConcurrentDeque() : records_(new Record[max_threads]), segments_(new atomic<Node*>[max_segments]())
+  {
+  }
+
+  ConcurrentDeque(const ConcurrentDeque&)            = delete;
+  ConcurrentDeque& operator=(const ConcurrentDeque&) = delete;
+
+  /**
+   * @brief Destroys the remaining elements. No other thread may use the
+   * deque any more.
+   */
+  ~ConcurrentDeque()
+  {
+    uint64_t a = anchor_.load();
+    for (uint32_t i = right_of(a); i != 0; i = i == left_of(a) ? 0 : node(i).left.load()) {
+      node(i).value()->~T();
+    }
+    for (size_t i = 0; i < max_segments; ++i) {
+      delete[] segments_[i].load();
+    }
+  }
+
+  void push_back(T value)
+  {
+    Guard    guard(*this);
+    uint32_t fresh = make_node(guard.record, move(value));
+    while (true) {
+      uint64_t a = anchor_.load();
+      if (right_of(a) == 0) {
+        if (anchor_.compare_exchange_weak(a, pack(fresh, fresh, Stable))) {
+          return;
+        }
+      }
+      else if (status_of(a) == Stable) {
+        node(fresh).left.store(right_of(a), memory_order_relaxed);
+        uint64_t pushed = pack(left_of(a), fresh, PushingBack);
+        if (anchor_.compare_exchange_weak(a, pushed)) {
+          stabilize_back(pushed);
+          return;
+        }
+      }
+      else {
+        stabilize(a);
+      }
+    }
+  }
+
+  void push_front(T value)
+  {
+    Guard    guard(*this);
+    uint32_t fresh = make_node(guard.record, move(value));
+    while (true) {
+      uint64_t a = anchor_.load();
+      if (left_of(a) == 0) {
+        if (anchor_.compare_exchange_weak(a, pack(fresh, fresh, Stable))) {
+          return;
+        }
+      }
+      else if (status_of(a) == Stable) {
+        node(fresh).right.store(left_of(a), memory_order_relaxed);
+        uint64_t pushed = pack(fresh, right_of(a), PushingFront);
+        if (anchor_.compare_exchange_weak(a, pushed)) {
+          stabilize_front(pushed);
+          return;
+        }
+      }
+      else {
+        stabilize(a);
+      }
+    }
+  }
+
+  /**
+   * @brief Removes the last element into out.
+   *
+   * @return bool False if the deque was empty.
+   */
+  bool try_pop_back(T& out)
+  {
+    Guard    guard(*this);
+    uint32_t last;
+    while (true) {
+      uint64_t a = anchor_.load();
+      last       = right_of(a);
+      if (last == 0) {
+        return false;
+      }
+      if (last == left_of(a)) {
+        if (anchor_.compare_exchange_weak(a, pack(0, 0, Stable))) {
+          break;
+        }
+      }
+      else if (status_of(a) == Stable) {
+        uint32_t prev = node(last).left.load();
+        if (anchor_.compare_exchange_weak(a, pack(left_of(a), prev, Stable))) {
+          break;
+        }
+      }
+      else {
+        stabilize(a);
+      }
+    }
+    take(guard.record, last, out);
+    return true;
+  }
+
+  /**
+   * @brief Removes the first element into out.
+   *
+   * @return bool False if the deque was empty.
+   */
+  bool try_pop_front(T& out)
+  {
+    Guard    guard(*this);
+    uint32_t first;
+    while (true) {
+      uint64_t a = anchor_.load();
+      first      = left_of(a);
+      if (first == 0) {
+        return false;
+      }
+      if (first == right_of(a)) {
+        if (anchor_.compare_exchange_weak(a, pack(0, 0, Stable))) {
+          break;
+        }
+      }
+      else if (status_of(a) == Stable) {
+        uint32_t next = node(first).right.load();
+        if (anchor_.compare_exchange_weak(a, pack(next, right_of(a), Stable))) {
+          break;
+        }
+      }
+      else {
+        stabilize(a);
+      }
+    }
+    take(guard.record, first, out);
+    return true;
+  }
+
+  /**
+   * @brief True if the deque was empty at the moment of the call.
+   */
+  bool empty() const
+  {
+    return right_of(anchor_.load()) == 0;
+  }
+
+private:
+  enum Status : uint64_t
+  {
+    Stable       = 0,
+    PushingBack  = 1,
+    PushingFront = 2
+  };
+
+  struct Node
+  {
+    atomic<uint32_t> left{0};
+    atomic<uint32_t> right{0}; // Also links the node in the shared free list
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T* value()
+    {
+      return launder(reinterpret_cast<T*>(storage));
+    }
+  };
+
+  /**
+   * @brief Per-thread state: the epoch the thread is reading in, the nodes
+   * it retired in the last three epochs and the indices it can reuse.
+   */
+  struct alignas(64) Record
+  {
+    atomic<uint64_t> epoch{0}; // 0 while the thread is not inside an operation
+    vector<uint32_t> retired[3];
+    uint64_t         retired_epoch[3] = {0, 0, 0};
+    vector<uint32_t> free;
+    size_t           retire_count = 0;
+  };
+
+  /**
+   * @brief Marks the calling thread as reading the deque for its lifetime.
+   */
+  struct Guard
+  {
+    explicit Guard(ConcurrentDeque& deque) : record(deque.records_[thread_slot()])
+    {
+      record.epoch.store(deque.epoch_.load());
+    }
+    ~Guard()
+    {
+      record.epoch.store(0, memory_order_release);
+    }
+
+    Record& record;
+  };
+
+  static constexpr unsigned index_bits    = 31;
+  static constexpr uint64_t index_mask    = (uint64_t(1) << index_bits) - 1;
+  static constexpr unsigned segment_bits  = 16;
+  static constexpr size_t   segment_size  = size_t(1) << segment_bits;
+  static constexpr size_t   max_segments  = (index_mask + 1) / segment_size;
+  static constexpr size_t   local_free    = 4096; // Indices a thread keeps for itself before sharing
+  static constexpr size_t   advance_every = 64;   // Retires between attempts to advance the epoch
+
+  // Anchor layout: front index in bits 0-30, back index in bits 31-61, status in bits 62-63
+  static uint64_t pack(uint32_t left, uint32_t right, uint64_t status)
+  {
+    return uint64_t(left) | uint64_t(right) << index_bits | status << (2 * index_bits);
+  }
+  static uint32_t left_of(uint64_t a)
+  {
+    return static_cast<uint32_t>(a & index_mask);
+  }
+  static uint32_t right_of(uint64_t a)
+  {
+    return static_cast<uint32_t>(a >> index_bits & index_mask);
+  }
+  static uint64_t status_of(uint64_t a)
+  {
+    return a >> (2 * index_bits);
+  }
+
+  Node& node(uint32_t index)
+  {
+    return segments_[index >> segment_bits].load(memory_order_acquire)[index & (segment_size - 1)];
+  }
+
+  void stabilize(uint64_t a)
+  {
+    if (status_of(a) == PushingBack) {
+      stabilize_back(a);
+    }
+    else {
+      stabilize_front(a);
+    }
+  }
+
+  /**
+   * @brief Links the node before the new back node to it, then marks the
+   * anchor stable. Does nothing if another thread got there first.
+   */
+  void stabilize_back(uint64_t a)
+  {
+    uint32_t last = right_of(a);
+    uint32_t prev = node(last).left.load();
+    if (anchor_.load() != a) {
+      return;
+    }
+    uint32_t prev_next = node(prev).right.load();
+    if (prev_next != last) {
+      if (anchor_.load() != a || !node(prev).right.compare_exchange_strong(prev_next, last)) {
+        return;
+      }
+    }
+    anchor_.compare_exchange_strong(a, pack(left_of(a), last, Stable));
+  }
+
+  void stabilize_front(uint64_t a)
+  {
+    uint32_t first = left_of(a);
+    uint32_t next  = node(first).right.load();
+    if (anchor_.load() != a) {
+      return;
+    }
+    uint32_t next_prev = node(next).left.load();
+    if (next_prev != first) {
+      if (anchor_.load() != a || !node(next).left.compare_exchange_strong(next_prev, first)) {
+        return;
+      }
+    }
+    anchor_.compare_exchange_strong(a, pack(first, right_of(a), Stable));
+  }
+
+  /**
+   * @brief Gets a free node index (from the thread, the shared free list or
+   * a never used one) and constructs value in it.
+   */
+  uint32_t make_node(Record& record, T&& value)
+  {
+    uint32_t index = 0;
+    if (!record.free.empty()) {
+      index = record.free.back();
+      record.free.pop_back();
+    }
+    else {
+      index = pop_shared_free();
+    }
+    if (index == 0) {
+      uint64_t fresh = next_index_.fetch_add(1);
+      if (fresh > index_mask) {
+        throw bad_alloc();
+      }
+      index = static_cast<uint32_t>(fresh);
+      ensure_segment(index >> segment_bits);
+    }
+    Node& n = node(index);
+    new (n.value()) T(move(value));
+    n.left.store(0, memory_order_relaxed);
+    n.right.store(0, memory_order_relaxed);
+    return index;
+  }
+
+  void ensure_segment(size_t segment)
+  {
+    if (segments_[segment].load(memory_order_acquire) != nullptr) {
+      return;
+    }
+    Node* fresh    = new Node[segment_size];
+    Node* expected = nullptr;
+    if (!segments_[segment].compare_exchange_strong(expected, fresh)) {
+      delete[] fresh;
+    }
+  }
+
+  /**
+   * @brief Moves the value out of a popped node and retires the node.
+   */
+  void take(Record& record, uint32_t index, T& out)
+  {
+    T* value = node(index).value();
+    out      = move(*value);
+    value->~T();
+    retire(record, index);
+  }
+
+  /**
+   * @brief Keeps a popped node until every thread that might still read it
+   * has left the deque: nodes retired in epoch e are reused from epoch e + 2.
+   * The three buckets hold the nodes of the last three epochs; a bucket from
+   * epoch e - 3 or older is released when it is reused.
+   */
+  void retire(Record& record, uint32_t index)
+  {
+    uint64_t e      = epoch_.load();
+    size_t   bucket = e % 3;
+    if (record.retired_epoch[bucket] != e) {
+      release(record, record.retired[bucket]);
+      record.retired_epoch[bucket] = e;
+    }
+    record.retired[bucket].push_back(index);
+    if (++record.retire_count % advance_every == 0) {
+      try_advance_epoch();
+    }
+  }
+
+  /**
+   * @brief Advances the global epoch if every thread inside an operation
+   * started it in the current epoch.
+   */
+  void try_advance_epoch()
+  {
+    uint64_t e = epoch_.load();
+    for (size_t i = 0; i < max_threads; ++i) {
+      uint64_t seen = records_[i].epoch.load();
+      if (seen != 0 && seen != e) {
+        return;
+      }
+    }
+    epoch_.compare_exchange_strong(e, e + 1);
+  }
+
+  /**
+   * @brief Makes retired indices reusable: first by this thread, and past
+   * local_free indices, by everyone through the shared free list.
+   */
+  void release(Record& record, vector<uint32_t>& indices)
+  {
+    record.free.insert(record.free.end(), indices.begin(), indices.end());
+    indices.clear();
+    if (record.free.size() > local_free) {
+      // Chain half of them through their right links and push the chain at once
+      size_t   keep  = local_free / 2;
+      uint32_t first = record.free[keep];
+      uint32_t last  = record.free.back();
+      for (size_t i = keep; i + 1 < record.free.size(); ++i) {
+        node(record.free[i]).right.store(record.free[i + 1], memory_order_relaxed);
+      }
+      record.free.resize(keep);
+      push_shared_free(first, last);
+    }
+  }
+
+  // The shared free list head holds a 32-bit index and a 32-bit version that
+  // changes on every update, so a stale compare-and-swap always fails.
+  void push_shared_free(uint32_t first, uint32_t last)
+  {
+    uint64_t head = free_head_.load();
+    do {
+      node(last).right.store(static_cast<uint32_t>(head), memory_order_relaxed);
+    } while (!free_head_.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | first));
+  }
+
+  uint32_t pop_shared_free()
+  {
+    uint64_t head = free_head_.load();
+    while (static_cast<uint32_t>(head) != 0) {
+      uint32_t next = node(static_cast<uint32_t>(head)).right.load(memory_order_relaxed);
+      if (free_head_.compare_exchange_weak(head, ((head >> 32) + 1) << 32 | next)) {
+        return static_cast<uint32_t>(head);
+      }
+    }
+    return 0;
+  }
+
+  atomic<uint64_t>            anchor_{0};
+  atomic<uint64_t>            epoch_{1};
+  atomic<uint64_t>            next_index_{1}; // Index 0 means "no node"
+  atomic<uint64_t>            free_head_{0};
+  unique_ptr<Record[]>        records_;
+  unique_ptr<atomic<Node*>[]> segments_; // Allocated on first use, freed with the deque
+};
+
+/**
+ * @brief std::list protected by a mutex, the usual way of sharing a list
+ * between threads. Used as the reference in the benchmark.
+ */
+template <typename T>
+class LockedList
+{
+public:
+  void push_back(T value)
+  {
+    lock_guard<mutex> lock(mutex_);
+    list_.push_back(move(value));
+  }
+  void push_front(T value)
+  {
+    lock_guard<mutex> lock(mutex_);
+    list_.push_front(move(value));
+  }
+  bool try_pop_back(T& out)
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (list_.empty()) {
+      return false;
+    }
+    out = move(list_.back());
+    list_.pop_back();
+    return true;
+  }
+  bool try_pop_front(T& out)
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (list_.empty()) {
+      return false;
+    }
+    out = move(list_.front());
+    list_.pop_front();
+    return true;
+  }
+
+private:
+  mutex   mutex_;
+  list<T> list_;
+};
+
+/**
+ * @brief Pushes and pops at both ends from one thread.
+ */
+void basic_concurrent_deque()
+{
+  ConcurrentDeque<int> deque;
+  deque.push_back(1);
+  deque.push_back(2);
+  deque.push_front(0);
+  deque.push_back(3);
+
+  int value = 0;
+  cout << "Lista: ";
+  while (deque.try_pop_front(value)) {
+    cout << value << ' ';
+  }
+  cout << '\n';
+}
+
+/**
+ * @brief Producers push distinct values at random ends while consumers pop
+ * from random ends. Checks that every value comes out exactly once.
+ *
+ * @return bool True if no value was lost or duplicated.
+ */
+bool stress_test(unsigned producers, unsigned consumers, size_t per_producer)
+{
+  ConcurrentDeque<uint64_t> deque;
+  atomic<unsigned>          producers_left{producers};
+  vector<vector<uint64_t>>  popped(consumers);
+  vector<thread>            threads;
+
+  for (unsigned p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      mt19937 rng(p);
+      for (size_t i = 0; i < per_producer; ++i) {
+        uint64_t value = uint64_t(p) * per_producer + i;
+        if (rng() % 2 == 0) {
+          deque.push_back(value);
+        }
+        else {
+          deque.push_front(value);
+        }
+      }
+      --producers_left;
+    });
+  }
+  for (unsigned c = 0; c < consumers; ++c) {
+    threads.emplace_back([&, c] {
+      mt19937  rng(1000 + c);
+      uint64_t value = 0;
+      while (true) {
+        bool got = rng() % 2 == 0 ? deque.try_pop_back(value) : deque.try_pop_front(value);
+        if (got) {
+          popped[c].push_back(value);
+        }
+        else if (producers_left == 0 && deque.empty()) {
+          break;
+        }
+      }
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  vector<uint64_t> all;
+  for (const auto& values : popped) {
+    all.insert(all.end(), values.begin(), values.end());
+  }
+  sort(all.begin(), all.end());
+  bool ok = all.size() == producers * per_producer;
+  for (size_t i = 0; ok && i < all.size(); ++i) {
+    ok = all[i] == i;
+  }
+  cout << "Stress test, " << producers << " producers and " << consumers << " consumers: " << all.size() << " values, "
+       << (ok ? "each one exactly once" : "LOST OR DUPLICATED VALUES") << '\n';
+  return ok;
+}
+
+/**
+ * @brief Every thread does ops operations, half pushes and half pops, at
+ * random ends of a shared deque.
+ *
+ * @return double Millions of operations per second.
+ */
+template <typename Deque>
+double throughput(unsigned num_threads, size_t ops)
+{
+  Deque deque;
+  for (int i = 0; i < 1000; ++i) {
+    deque.push_back(i);
+  }
+
+  vector<thread> threads;
+  auto           start = chrono::steady_clock::now();
+  for (unsigned t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&deque, ops, t] {
+      mt19937 rng(t);
+      int     value = 0;
+      for (size_t i = 0; i < ops; ++i) {
+        switch (rng() % 4) {
+        case 0:
+          deque.push_back(static_cast<int>(i));
+          break;
+        case 1:
+          deque.push_front(static_cast<int>(i));
+          break;
+        case 2:
+          deque.try_pop_back(value);
+          break;
+        default:
+          deque.try_pop_front(value);
+          break;
+        }
+      }
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+  double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  return static_cast<double>(num_threads * ops) / seconds / 1e6;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of operations per thread of the benchmark can be passed as the
+ * first argument.
+ *
+ * @return int Returns 0 if the stress tests pass.
+ */
+int main(int argc, char* argv[])
+{
+  basic_concurrent_deque();
+
+  size_t ops = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+  bool   ok  = stress_test(1, 1, ops) && stress_test(4, 4, ops / 4) && stress_test(8, 2, ops / 8);
+
+  cout << "\nThroughput (millions of operations per second)" << '\n';
+  unsigned max_benchmark_threads = max(8u, thread::hardware_concurrency());
+  for (unsigned t = 1; t <= max_benchmark_threads; t *= 2) {
+    cout << t << " threads: ConcurrentDeque " << throughput<ConcurrentDeque<int>>(t, ops) << ", mutex + list " << throughput<LockedList<int>>(t, ops)
+         << '\n';
+  }
+
+  return ok ? 0 : 1;
+}
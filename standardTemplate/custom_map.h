@@ -0,0 +1,32 @@
+/**
+ * @file custom_map.h
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  The map of maps.cpp: CustomKey to CustomValue, indexed by id.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * maps.cpp edits this map from its menu, and write_ahead_log.cpp makes its
+ * changes durable, so both use the same definition.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef CUSTOM_MAP_H
+#define CUSTOM_MAP_H
+
+#include "custom_types.h"
+#include "indexed_map.h"
+
+// Returns the id of a key, the part of the key the map is indexed by
+struct CustomKeyId
+{
+  int operator()(const CustomKey& key) const
+  {
+    return key.id;
+  }
+};
+
+// Map from CustomKey to CustomValue, with an index to look entries up by id
+using CustomMap = IndexedMap<CustomKey, CustomValue, CustomKeyId>;
+
+#endif // CUSTOM_MAP_H
@@ -0,0 +1,131 @@
+/**
+ * @file custom_types.h
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Key and value types of the map of maps.cpp.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * maps.cpp and the programs that build other containers for the same data
+ * (flat_map.cpp, swiss_map.cpp, bplus_tree.cpp, ...) all store CustomKey to
+ * CustomValue entries, so the two classes are defined once here, along with
+ * the view, the ordering and the hash those containers search with.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef CUSTOM_TYPES_H
+#define CUSTOM_TYPES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Custom class to use as a key in the map
+class CustomKey
+{
+public:
+  int         id;
+  std::string name;
+
+  CustomKey(int key_id, std::string key_name) : id(key_id), name(std::move(key_name))
+  {
+  }
+
+  bool operator<(const CustomKey& other) const
+  {
+    if (id == other.id) {
+      return name < other.name;
+    }
+    else {
+      return id < other.id;
+    }
+  }
+};
+
+// Custom class to use as a value in the map
+class CustomValue
+{
+public:
+  int         age;
+  std::string address;
+
+  CustomValue() : age(0), address("")
+  {
+  } // Default constructor
+
+  CustomValue(int value_age, std::string value_address) : age(value_age), address(std::move(value_address))
+  {
+  }
+};
+
+/**
+ * @brief Key for lookups that does not own its name.
+ */
+struct CustomKeyView
+{
+  int              id;
+  std::string_view name;
+};
+
+/**
+ * @brief Orders CustomKey and CustomKeyView alike, by id and then by name,
+ * like CustomKey::operator<. is_transparent lets the containers search with a
+ * CustomKeyView.
+ */
+struct CustomKeyLess
+{
+  using is_transparent = void;
+
+  template <typename A, typename B>
+  bool operator()(const A& a, const B& b) const
+  {
+    if (a.id == b.id) {
+      return std::string_view(a.name) < std::string_view(b.name);
+    }
+    return a.id < b.id;
+  }
+};
+
+/**
+ * @brief Hash of a CustomKey or a CustomKeyView: the hash of the name mixed
+ * with the id, then scrambled so every bit of the result depends on both.
+ * Open addressing tables use the low and the high bits separately, and
+ * sharded containers pick the shard from them, so a plain XOR is not enough.
+ */
+struct CustomKeyHash
+{
+  using is_transparent = void;
+
+  template <typename K>
+  std::size_t operator()(const K& key) const
+  {
+    std::uint64_t h = std::hash<std::string_view>()(std::string_view(key.name));
+    h ^= static_cast<std::uint64_t>(static_cast<std::uint32_t>(key.id)) * 0x9E3779B97F4A7C15ull;
+    // Final mix of MurmurHash3
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return static_cast<std::size_t>(h);
+  }
+};
+
+/**
+ * @brief Equality of CustomKey and CustomKeyView.
+ */
+struct CustomKeyEqual
+{
+  using is_transparent = void;
+
+  template <typename A, typename B>
+  bool operator()(const A& a, const B& b) const
+  {
+    return a.id == b.id && std::string_view(a.name) == std::string_view(b.name);
+  }
+};
+
+#endif // CUSTOM_TYPES_H
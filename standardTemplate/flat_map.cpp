@@ -0,0 +1,649 @@
+/**
+ * @file flat_map.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Sorted vector map with heterogeneous lookup for the CustomKey of
+ * maps.cpp.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * map<CustomKey, CustomValue> allocates one tree node per entry, and a lookup
+ * needs a CustomKey, which copies the name into a std::string. FlatMap keeps
+ * its entries sorted in vectors: lookups are binary searches over contiguous
+ * memory, and a transparent comparator lets them take an (id, string_view)
+ * pair without building a CustomKey.
+ *
+ * The keys and the values can live in separate arrays (the default), so a
+ * search only touches keys and a scan over the values does not touch the
+ * keys, or together in one array of pairs.
+ *
+ * Inserting or erasing one entry moves the entries after it, so FlatMap suits
+ * dictionaries that are built once (insert() of a whole range sorts and
+ * merges in O(n log n)) and then mostly read.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "custom_types.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Sorted map stored in vectors.
+ *
+ * Iterators are random access and dereference to a pair<const Key&, Value&>
+ * (by value, like a proxy), so structured bindings work. Insertions and
+ * erasures invalidate all iterators.
+ *
+ * @tparam Key     Key type.
+ * @tparam Value   Mapped type.
+ * @tparam Compare Order of the keys. Lookups accept any type it can compare
+ *                 with Key if it defines is_transparent.
+ * @tparam Split   Store keys and values in separate arrays.
+ */
+template <typename Key, typename Value, typename Compare = less<Key>, bool Split = true>
+class FlatMap
+{
+  /**
+   * @brief Keys and values in two arrays.
+   */
+  struct SplitStorage
+  {
+    vector<Key>   keys;
+    vector<Value> values;
+
+    const Key& key(size_t i) const
+    {
+      return keys[i];
+    }
+    Value& value(size_t i)
+    {
+      return values[i];
+    }
+    size_t size() const
+    {
+      return keys.size();
+    }
+    void reserve(size_t n)
+    {
+      keys.reserve(n);
+      values.reserve(n);
+    }
+    template <typename K, typename V>
+    void insert(size_t i, K&& key, V&& value)
+    {
+      keys.insert(keys.begin() + static_cast<ptrdiff_t>(i), forward<K>(key));
+      values.insert(values.begin() + static_cast<ptrdiff_t>(i), forward<V>(value));
+    }
+    template <typename K, typename V>
+    void push_back(K&& key, V&& value)
+    {
+      keys.push_back(forward<K>(key));
+      values.push_back(forward<V>(value));
+    }
+    pair<Key, Value> take(size_t i)
+    {
+      return {move(keys[i]), move(values[i])};
+    }
+    void erase(size_t first, size_t last)
+    {
+      keys.erase(keys.begin() + static_cast<ptrdiff_t>(first), keys.begin() + static_cast<ptrdiff_t>(last));
+      values.erase(values.begin() + static_cast<ptrdiff_t>(first), values.begin() + static_cast<ptrdiff_t>(last));
+    }
+    void clear()
+    {
+      keys.clear();
+      values.clear();
+    }
+    template <typename K>
+    size_t lower_bound(const K& key, const Compare& comp) const
+    {
+      return static_cast<size_t>(std::lower_bound(keys.begin(), keys.end(), key, comp) - keys.begin());
+    }
+  };
+
+  /**
+   * @brief Keys and values in one array of pairs.
+   */
+  struct PairStorage
+  {
+    vector<pair<Key, Value>> entries;
+
+    const Key& key(size_t i) const
+    {
+      return entries[i].first;
+    }
+    Value& value(size_t i)
+    {
+      return entries[i].second;
+    }
+    size_t size() const
+    {
+      return entries.size();
+    }
+    void reserve(size_t n)
+    {
+      entries.reserve(n);
+    }
+    template <typename K, typename V>
+    void insert(size_t i, K&& key, V&& value)
+    {
+      entries.emplace(entries.begin() + static_cast<ptrdiff_t>(i), forward<K>(key), forward<V>(value));
+    }
+    template <typename K, typename V>
+    void push_back(K&& key, V&& value)
+    {
+      entries.emplace_back(forward<K>(key), forward<V>(value));
+    }
+    pair<Key, Value> take(size_t i)
+    {
+      return move(entries[i]);
+    }
+    void erase(size_t first, size_t last)
+    {
+      entries.erase(entries.begin() + static_cast<ptrdiff_t>(first), entries.begin() + static_cast<ptrdiff_t>(last));
+    }
+    void clear()
+    {
+      entries.clear();
+    }
+    template <typename K>
+    size_t lower_bound(const K& key, const Compare& comp) const
+    {
+      auto it = std::lower_bound(entries.begin(), entries.end(), key, [&comp](const pair<Key, Value>& e, const K& k) { return comp(e.first, k); });
+      return static_cast<size_t>(it - entries.begin());
+    }
+  };
+
+  using Storage = conditional_t<Split, SplitStorage, PairStorage>;
+
+  // Lookups take any key type when the comparator is transparent, and only Key otherwise
+  template <typename K, typename C = Compare, typename = typename C::is_transparent>
+  static const K& lookup_key(const K& key, int)
+  {
+    return key;
+  }
+  template <typename K>
+  static const Key& lookup_key(const Key& key, long)
+  {
+    return key;
+  }
+
+public:
+  using key_type    = Key;
+  using mapped_type = Value;
+  using reference   = pair<const Key&, Value&>;
+
+  template <bool Const>
+  class basic_iterator
+  {
+    using Map = conditional_t<Const, const FlatMap, FlatMap>;
+
+  public:
+    using iterator_category = random_access_iterator_tag;
+    using value_type        = pair<Key, Value>;
+    using difference_type   = ptrdiff_t;
+    using reference         = pair<const Key&, conditional_t<Const, const Value&, Value&>>;
+
+    struct pointer
+    {
+      reference ref;
+      reference* operator->()
+      {
+        return &ref;
+      }
+    };
+
+    basic_iterator() = default;
+    basic_iterator(Map* map, size_t index) : map_(map), index_(index)
+    {
+    }
+    // An iterator converts to a const_iterator, not the other way around.
+    template <bool OtherConst, typename = enable_if_t<Const && !OtherConst>>
+    basic_iterator(const basic_iterator<OtherConst>& other) : map_(other.map_), index_(other.index_)
+    {
+    }
+
+    reference operator*() const
+    {
+      return {map_->storage_.key(index_), const_cast<FlatMap*>(map_)->storage_.value(index_)};
+    }
+    pointer operator->() const
+    {
+      return pointer{**this};
+    }
+    reference operator[](difference_type n) const
+    {
+      return *(*this + n);
+    }
+
+    basic_iterator& operator++()
+    {
+      ++index_;
+      return *this;
+    }
+    basic_iterator operator++(int)
+    {
+      basic_iterator old = *this;
+      ++index_;
+      return old;
+    }
+    basic_iterator& operator--()
+    {
+      --index_;
+      return *this;
+    }
+    basic_iterator operator--(int)
+    {
+      basic_iterator old = *this;
+      --index_;
+      return old;
+    }
+    basic_iterator& operator+=(difference_type n)
+    {
+      index_ = static_cast<size_t>(static_cast<difference_type>(index_) + n);
+      return *this;
+    }
+    basic_iterator& operator-=(difference_type n)
+    {
+      return *this += -n;
+    }
+    friend basic_iterator operator+(basic_iterator it, difference_type n)
+    {
+      return it += n;
+    }
+    friend basic_iterator operator-(basic_iterator it, difference_type n)
+    {
+      return it -= n;
+    }
+    friend difference_type operator-(const basic_iterator& a, const basic_iterator& b)
+    {
+      return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+    }
+    friend bool operator==(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ == b.index_;
+    }
+    friend bool operator!=(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ != b.index_;
+    }
+    friend bool operator<(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ < b.index_;
+    }
+    friend bool operator>(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ > b.index_;
+    }
+    friend bool operator<=(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ <= b.index_;
+    }
+    friend bool operator>=(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ >= b.index_;
+    }
+
+  private:
+    friend class FlatMap;
+    template <bool>
+    friend class basic_iterator;
+
+    Map*   map_   = nullptr;
+    size_t index_ = 0;
+  };
+
+  using iterator       = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  FlatMap() = default;
+
+  explicit FlatMap(Compare comp) : comp_(comp)
+  {
+  }
+
+  iterator begin()
+  {
+    return iterator(this, 0);
+  }
+  iterator end()
+  {
+    return iterator(this, size());
+  }
+  const_iterator begin() const
+  {
+    return const_iterator(this, 0);
+  }
+  const_iterator end() const
+  {
+    return const_iterator(this, size());
+  }
+
+  size_t size() const
+  {
+    return storage_.size();
+  }
+
+  bool empty() const
+  {
+    return storage_.size() == 0;
+  }
+
+  void reserve(size_t n)
+  {
+    storage_.reserve(n);
+  }
+
+  void clear()
+  {
+    storage_.clear();
+  }
+
+  /**
+   * @brief The values array, for scans that do not need the keys. Only
+   * available with split storage.
+   */
+  template <bool S = Split, typename = enable_if_t<S>>
+  const vector<Value>& values() const
+  {
+    return storage_.values;
+  }
+
+  template <typename K>
+  iterator find(const K& key)
+  {
+    return iterator(this, find_index(lookup_key<K>(key, 0)));
+  }
+
+  template <typename K>
+  const_iterator find(const K& key) const
+  {
+    return const_iterator(this, find_index(lookup_key<K>(key, 0)));
+  }
+
+  template <typename K>
+  bool contains(const K& key) const
+  {
+    return find_index(lookup_key<K>(key, 0)) != size();
+  }
+
+  template <typename K>
+  iterator lower_bound(const K& key)
+  {
+    return iterator(this, storage_.lower_bound(lookup_key<K>(key, 0), comp_));
+  }
+
+  /**
+   * @throws std::out_of_range if the key is not in the map.
+   */
+  template <typename K>
+  Value& at(const K& key)
+  {
+    size_t i = find_index(lookup_key<K>(key, 0));
+    if (i == size()) {
+      throw out_of_range("FlatMap::at: key not found");
+    }
+    return storage_.value(i);
+  }
+
+  Value& operator[](const Key& key)
+  {
+    size_t i = storage_.lower_bound(key, comp_);
+    if (i == size() || comp_(key, storage_.key(i))) {
+      storage_.insert(i, key, Value());
+    }
+    return storage_.value(i);
+  }
+
+  /**
+   * @brief Inserts a key that is not in the map yet.
+   *
+   * @return pair<iterator, bool> The entry of the key, and whether it was inserted.
+   */
+  pair<iterator, bool> insert(Key key, Value value)
+  {
+    size_t i = storage_.lower_bound(key, comp_);
+    if (i != size() && !comp_(key, storage_.key(i))) {
+      return {iterator(this, i), false};
+    }
+    storage_.insert(i, move(key), move(value));
+    return {iterator(this, i), true};
+  }
+
+  pair<iterator, bool> insert_or_assign(Key key, Value value)
+  {
+    size_t i = storage_.lower_bound(key, comp_);
+    if (i != size() && !comp_(key, storage_.key(i))) {
+      storage_.value(i) = move(value);
+      return {iterator(this, i), false};
+    }
+    storage_.insert(i, move(key), move(value));
+    return {iterator(this, i), true};
+  }
+
+  /**
+   * @brief Inserts a range of (key, value) pairs at once.
+   *
+   * The batch is sorted (skipped if it already is), then merged with the
+   * current entries in one linear pass. As with std::map::insert, keys that
+   * are already in the map keep their value, and within the batch the first
+   * occurrence of a key wins.
+   */
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last)
+  {
+    vector<pair<Key, Value>> batch(first, last);
+    auto                     by_key = [this](const pair<Key, Value>& a, const pair<Key, Value>& b) { return comp_(a.first, b.first); };
+    if (!is_sorted(batch.begin(), batch.end(), by_key)) {
+      stable_sort(batch.begin(), batch.end(), by_key);
+    }
+    auto same_key = [this](const pair<Key, Value>& a, const pair<Key, Value>& b) { return !comp_(a.first, b.first); };
+    batch.erase(unique(batch.begin(), batch.end(), same_key), batch.end());
+
+    Storage merged;
+    merged.reserve(size() + batch.size());
+    size_t i = 0;
+    for (size_t j = 0; j < batch.size(); ++j) {
+      while (i < size() && comp_(storage_.key(i), batch[j].first)) {
+        auto entry = storage_.take(i++);
+        merged.push_back(move(entry.first), move(entry.second));
+      }
+      if (i == size() || comp_(batch[j].first, storage_.key(i))) {
+        merged.push_back(move(batch[j].first), move(batch[j].second));
+      }
+    }
+    for (; i < size(); ++i) {
+      auto entry = storage_.take(i);
+      merged.push_back(move(entry.first), move(entry.second));
+    }
+    storage_ = move(merged);
+  }
+
+  iterator erase(const_iterator pos)
+  {
+    storage_.erase(pos.index_, pos.index_ + 1);
+    return iterator(this, pos.index_);
+  }
+
+  // Without it, erase(find(key)) would pick the key template below, which
+  // matches an iterator exactly
+  iterator erase(iterator pos)
+  {
+    return erase(const_iterator(pos));
+  }
+
+  template <typename K>
+  size_t erase(const K& key)
+  {
+    size_t i = find_index(lookup_key<K>(key, 0));
+    if (i == size()) {
+      return 0;
+    }
+    storage_.erase(i, i + 1);
+    return 1;
+  }
+
+private:
+  template <typename K>
+  size_t find_index(const K& key) const
+  {
+    size_t i = storage_.lower_bound(key, comp_);
+    return i != size() && !comp_(key, storage_.key(i)) ? i : size();
+  }
+
+  Storage storage_;
+  Compare comp_;
+};
+
+using CustomFlatMap = FlatMap<CustomKey, CustomValue, CustomKeyLess>;
+
+/**
+ * @brief Prints the entries of a flat map, in the same format as print_map()
+ * in maps.cpp.
+ */
+template <typename Map>
+void print_map(const Map& m)
+{
+  for (const auto& [key, value] : m) {
+    cout << "Name: " << key.name << " ID(" << key.id << ") -> Age: " << value.age << ", Address: " << value.address << '\n';
+  }
+}
+
+/**
+ * @brief Same operations as the menu of maps.cpp, on a CustomFlatMap.
+ */
+void basic_flat_map()
+{
+  CustomFlatMap m;
+  // Predefine
+  vector<pair<CustomKey, CustomValue>> predefined = {{CustomKey(3, "Charlie"), CustomValue(35, "789 Oak St")},
+                                                      {CustomKey(1, "Alice"), CustomValue(25, "123 Main St")},
+                                                      {CustomKey(2, "Bob"), CustomValue(30, "456 Elm St")}};
+  m.insert(predefined.begin(), predefined.end());
+  print_map(m);
+
+  // Insert
+  m[CustomKey(4, "Dave")] = CustomValue(41, "12 Pine St");
+  // Modify, looking the key up without building a CustomKey
+  m.at(CustomKeyView{2, "Bob"}).age = 31;
+  // Remove
+  m.erase(CustomKeyView{1, "Alice"});
+  print_map(m);
+
+  // Find
+  auto it = m.find(CustomKeyView{3, "Charlie"});
+  if (it != m.end()) {
+    cout << "Found ID: " << it->first.id << " Name: " << it->first.name << " -> Age: " << it->second.age << ", Address: " << it->second.address << '\n';
+  }
+  cout << "The size of the map is: " << m.size() << '\n';
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Builds a std::map and both FlatMap layouts with the same entries,
+ * then times lookups and a scan of the values.
+ *
+ * @param n Number of entries.
+ * @return bool True if every container finds the same entries.
+ */
+bool benchmark(size_t n)
+{
+  mt19937                              rng(40);
+  vector<pair<CustomKey, CustomValue>> entries;
+  entries.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    int id = static_cast<int>(rng() % (4 * n));
+    entries.emplace_back(CustomKey(id, "user" + to_string(id)), CustomValue(static_cast<int>(rng() % 100), "Street " + to_string(i)));
+  }
+  vector<pair<int, string>> queries;
+  for (size_t i = 0; i < n; ++i) {
+    const auto& key = entries[rng() % n].first;
+    queries.emplace_back(key.id, key.name);
+  }
+
+  cout << "\nBenchmark with " << n << " entries" << '\n';
+
+  map<CustomKey, CustomValue>                           tree;
+  FlatMap<CustomKey, CustomValue, CustomKeyLess>        split;
+  FlatMap<CustomKey, CustomValue, CustomKeyLess, false> pairs;
+  cout << "build     map: " << time_ms([&] {
+    for (const auto& e : entries) {
+      tree.insert(e);
+    }
+  }) << " ms, flat (split): " << time_ms([&] { split.insert(entries.begin(), entries.end()); })
+       << " ms, flat (pairs): " << time_ms([&] { pairs.insert(entries.begin(), entries.end()); }) << " ms\n";
+
+  long long tree_sum = 0, split_sum = 0, pairs_sum = 0;
+  cout << "lookup    map: " << time_ms([&] {
+    for (const auto& q : queries) {
+      tree_sum += tree.find(CustomKey(q.first, q.second))->second.age;
+    }
+  }) << " ms, flat (split): " << time_ms([&] {
+    for (const auto& q : queries) {
+      split_sum += split.find(CustomKeyView{q.first, q.second})->second.age;
+    }
+  }) << " ms, flat (pairs): " << time_ms([&] {
+    for (const auto& q : queries) {
+      pairs_sum += pairs.find(CustomKeyView{q.first, q.second})->second.age;
+    }
+  }) << " ms\n";
+
+  long long tree_ages = 0, split_ages = 0, pairs_ages = 0;
+  cout << "scan ages map: " << time_ms([&] {
+    for (const auto& e : tree) {
+      tree_ages += e.second.age;
+    }
+  }) << " ms, flat (split): " << time_ms([&] {
+    for (const auto& value : split.values()) {
+      split_ages += value.age;
+    }
+  }) << " ms, flat (pairs): " << time_ms([&] {
+    for (const auto& e : pairs) {
+      pairs_ages += e.second.age;
+    }
+  }) << " ms\n";
+
+  return tree.size() == split.size() && split.size() == pairs.size() && tree_sum == split_sum && split_sum == pairs_sum && tree_ages == split_ages
+         && split_ages == pairs_ages;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of entries of the benchmark can be passed as the first
+ * argument.
+ *
+ * @return int Returns 0 if every container gives the same results.
+ */
+int main(int argc, char* argv[])
+{
+  basic_flat_map();
+
+  bool ok = benchmark(argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000);
+  cout << "Same results: " << (ok ? "yes" : "no") << '\n';
+
+  return ok ? 0 : 1;
+}
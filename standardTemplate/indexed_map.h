@@ -0,0 +1,305 @@
+/**
+ * @file indexed_map.h
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Ordered map with a hash index on the id part of its keys.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * The map of maps.cpp is keyed by (id, name), but find, modify and remove
+ * look entries up by id alone, which means walking the whole map. IndexedMap
+ * keeps the ordered std::map and, next to it, an unordered_map from each id
+ * to the first entry with that id, so a lookup by id takes O(1) on average.
+ *
+ * The keys must be ordered by id first, so the entries that share an id are
+ * next to each other in the map: the index only stores the first of them.
+ * Every insertion and erasure goes through IndexedMap, which keeps the
+ * index up to date.
+ *
+ * bulk_load() adds a whole batch at once: it sorts the batch (on several
+ * threads when it is large), keeps the last value of each repeated key and
+ * moves the entries into the map in order, each one next to the previous
+ * one, so building an empty map takes O(n) after the sort.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef INDEXED_MAP_H
+#define INDEXED_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief std::map with an index from id to the first entry with that id.
+ *
+ * @tparam Key     Key type, ordered by Compare with the id as first criterion.
+ * @tparam Value   Mapped type.
+ * @tparam IdOf    Function object returning the id of a key.
+ * @tparam Compare Order of the keys.
+ */
+template <typename Key, typename Value, typename IdOf, typename Compare = std::less<Key>>
+class IndexedMap
+{
+public:
+  using map_type       = std::map<Key, Value, Compare>;
+  using iterator       = typename map_type::iterator;
+  using const_iterator = typename map_type::const_iterator;
+  using id_type        = std::decay_t<decltype(std::declval<IdOf>()(std::declval<const Key&>()))>;
+
+  iterator begin()
+  {
+    return primary_.begin();
+  }
+  iterator end()
+  {
+    return primary_.end();
+  }
+  const_iterator begin() const
+  {
+    return primary_.begin();
+  }
+  const_iterator end() const
+  {
+    return primary_.end();
+  }
+
+  /**
+   * @brief The ordered map. It is read-only: changes must go through
+   * IndexedMap to keep the index valid.
+   */
+  const map_type& primary() const
+  {
+    return primary_;
+  }
+
+  size_t size() const
+  {
+    return primary_.size();
+  }
+
+  bool empty() const
+  {
+    return primary_.empty();
+  }
+
+  /**
+   * @brief Returns the value of key, inserting a default one if needed.
+   */
+  Value& operator[](const Key& key)
+  {
+    auto result = primary_.try_emplace(key);
+    if (result.second) {
+      index_inserted(result.first);
+    }
+    return result.first->second;
+  }
+
+  std::pair<iterator, bool> insert_or_assign(Key key, Value value)
+  {
+    auto result = primary_.insert_or_assign(std::move(key), std::move(value));
+    if (result.second) {
+      index_inserted(result.first);
+    }
+    return result;
+  }
+
+  /**
+   * @brief Inserts or assigns every entry of batch. If a key appears more
+   * than once, its last value in batch is kept.
+   *
+   * Pass the batch with std::move: its keys and values are then moved into
+   * the map without a single copy.
+   *
+   * @return size_t The number of keys that were inserted.
+   */
+  size_t bulk_load(std::vector<std::pair<Key, Value>> batch)
+  {
+    auto by_key = [this](const std::pair<Key, Value>& a, const std::pair<Key, Value>& b) { return primary_.key_comp()(a.first, b.first); };
+    if (!std::is_sorted(batch.begin(), batch.end(), by_key)) {
+      stable_sort_batch(batch, by_key); // Stable, so the last value of a key is still the last one
+    }
+
+    // Last one wins: each value replaces the one before it with the same key
+    size_t kept = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+      if (kept > 0 && !by_key(batch[kept - 1], batch[i])) {
+        batch[kept - 1].second = std::move(batch[i].second);
+      }
+      else if (kept++ != i) {
+        batch[kept - 1] = std::move(batch[i]);
+      }
+    }
+    batch.erase(batch.begin() + static_cast<std::ptrdiff_t>(kept), batch.end());
+
+    // Each key goes right after the previous one, unless the map already has
+    // keys in between: then the hint is wrong and the map searches normally
+    size_t   inserted = 0;
+    iterator hint     = primary_.end();
+    if (!batch.empty() && !primary_.empty()) {
+      hint = primary_.lower_bound(batch.front().first);
+    }
+    index_.reserve(index_.size() + batch.size());
+    for (auto& entry : batch) {
+      size_t   before = primary_.size();
+      iterator it     = primary_.insert_or_assign(hint, std::move(entry.first), std::move(entry.second));
+      if (primary_.size() != before) {
+        index_inserted(it);
+        ++inserted;
+      }
+      hint = std::next(it);
+    }
+    return inserted;
+  }
+
+  iterator find(const Key& key)
+  {
+    return primary_.find(key);
+  }
+
+  /**
+   * @brief Returns the first entry (in key order) with the given id, or end().
+   */
+  iterator find_id(const id_type& id)
+  {
+    auto slot = index_.find(id);
+    return slot == index_.end() ? primary_.end() : slot->second;
+  }
+
+  const_iterator find_id(const id_type& id) const
+  {
+    auto slot = index_.find(id);
+    return slot == index_.end() ? primary_.end() : const_iterator(slot->second);
+  }
+
+  /**
+   * @brief Returns the range of entries with the given id.
+   */
+  std::pair<iterator, iterator> equal_range_id(const id_type& id)
+  {
+    iterator first = find_id(id);
+    iterator last  = first;
+    while (last != primary_.end() && id_of_(last->first) == id) {
+      ++last;
+    }
+    return {first, last};
+  }
+
+  iterator erase(const_iterator pos)
+  {
+    auto slot = index_.find(id_of_(pos->first));
+    if (const_iterator(slot->second) == pos) {
+      // pos was the first entry with its id: the next one takes its place, if any
+      iterator following = std::next(primary_.erase(pos, pos)); // erase(pos, pos) turns pos into an iterator
+      if (following != primary_.end() && id_of_(following->first) == slot->first) {
+        slot->second = following;
+      }
+      else {
+        index_.erase(slot);
+      }
+    }
+    return primary_.erase(pos);
+  }
+
+  size_t erase(const Key& key)
+  {
+    auto it = primary_.find(key);
+    if (it == primary_.end()) {
+      return 0;
+    }
+    erase(it);
+    return 1;
+  }
+
+  /**
+   * @brief Removes every entry with the given id.
+   *
+   * @return size_t The number of entries removed.
+   */
+  size_t erase_id(const id_type& id)
+  {
+    auto   range = equal_range_id(id);
+    size_t count = static_cast<size_t>(std::distance(range.first, range.second));
+    if (count != 0) {
+      primary_.erase(range.first, range.second);
+      index_.erase(id);
+    }
+    return count;
+  }
+
+  void clear()
+  {
+    primary_.clear();
+    index_.clear();
+  }
+
+  void reserve(size_t count)
+  {
+    index_.reserve(count);
+  }
+
+private:
+  /**
+   * @brief Sorts batch with a stable sort. Large batches are split in one part
+   * per hardware thread, sorted at the same time and then merged.
+   */
+  template <typename Less>
+  static void stable_sort_batch(std::vector<std::pair<Key, Value>>& batch, Less by_key)
+  {
+    constexpr size_t min_part = 1 << 16; // Smaller parts are not worth a thread
+    size_t           parts    = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), batch.size() / min_part);
+    if (parts < 2) {
+      std::stable_sort(batch.begin(), batch.end(), by_key);
+      return;
+    }
+
+    std::vector<size_t> bounds;
+    for (size_t p = 0; p <= parts; ++p) {
+      bounds.push_back(batch.size() * p / parts);
+    }
+    auto at = [&batch, &bounds](size_t p) { return batch.begin() + static_cast<std::ptrdiff_t>(bounds[p]); };
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < parts; ++p) {
+      threads.emplace_back([&, p] { std::stable_sort(at(p), at(p + 1), by_key); });
+    }
+    for (auto& th : threads) {
+      th.join();
+    }
+    // Merge neighbouring parts, doubling their size each round. The left part
+    // goes first, which keeps the sort stable
+    for (size_t width = 1; width < parts; width *= 2) {
+      threads.clear();
+      for (size_t p = 0; p + width < parts; p += 2 * width) {
+        threads.emplace_back([&, p, width] { std::inplace_merge(at(p), at(p + width), at(std::min(p + 2 * width, parts)), by_key); });
+      }
+      for (auto& th : threads) {
+        th.join();
+      }
+    }
+  }
+
+  /**
+   * @brief Records a new entry in the index if it is the first with its id.
+   */
+  void index_inserted(iterator it)
+  {
+    auto result = index_.try_emplace(id_of_(it->first), it);
+    if (!result.second && primary_.key_comp()(it->first, result.first->second->first)) {
+      result.first->second = it;
+    }
+  }
+
+  map_type                              primary_;
+  std::unordered_map<id_type, iterator> index_;
+  IdOf                                  id_of_;
+};
+
+#endif // INDEXED_MAP_H
@@ -0,0 +1,511 @@
+/**
+ * @file indexed_sequence.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Sequence container with O(log n) insert, erase and access by
+ * position, plus split and concatenation.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * The insert and remove options of lists.cpp walk the list with advance() to
+ * reach a position, so every positional edit costs O(n). IndexedSequence is
+ * an implicit treap: a randomized balanced binary tree ordered by position
+ * where every node stores the size of its subtree. Positions are found by
+ * descending the tree, so insert, erase and operator[] take O(log n) expected
+ * time, and a sequence can be split or concatenated in O(log n) as well.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Sequence of values indexed by position, backed by an implicit treap.
+ *
+ * @tparam T Type of the elements.
+ */
+template <typename T>
+class IndexedSequence
+{
+public:
+  IndexedSequence() = default;
+
+  /**
+   * @brief Builds a sequence from a range in O(n).
+   */
+  template <typename It>
+  IndexedSequence(It first, It last)
+  {
+    // Linear-time treap construction: keep the right spine of the tree on a
+    // stack. A node popped off the spine is final, so its size is computed then.
+    vector<Node*> spine;
+    for (; first != last; ++first) {
+      Node* node        = new Node(*first, next_priority());
+      Node* last_popped = nullptr;
+      while (!spine.empty() && spine.back()->priority < node->priority) {
+        last_popped = spine.back();
+        update(last_popped);
+        spine.pop_back();
+      }
+      node->left = last_popped;
+      if (!spine.empty()) {
+        spine.back()->right = node;
+      }
+      spine.push_back(node);
+    }
+    while (!spine.empty()) {
+      root_ = spine.back();
+      update(root_);
+      spine.pop_back();
+    }
+  }
+
+  IndexedSequence(initializer_list<T> values) : IndexedSequence(values.begin(), values.end())
+  {
+  }
+
+  IndexedSequence(const IndexedSequence& other) : root_(clone(other.root_)), seed_(other.seed_)
+  {
+  }
+
+  IndexedSequence(IndexedSequence&& other) noexcept : root_(other.root_), seed_(other.seed_)
+  {
+    other.root_ = nullptr;
+  }
+
+  IndexedSequence& operator=(IndexedSequence other) noexcept
+  {
+    swap(root_, other.root_);
+    swap(seed_, other.seed_);
+    return *this;
+  }
+
+  ~IndexedSequence()
+  {
+    destroy(root_);
+  }
+
+  size_t size() const
+  {
+    return size_of(root_);
+  }
+
+  bool empty() const
+  {
+    return root_ == nullptr;
+  }
+
+  /**
+   * @brief Returns the element at the given position, without bounds checking.
+   */
+  T& operator[](size_t position)
+  {
+    return find(position)->value;
+  }
+
+  const T& operator[](size_t position) const
+  {
+    return find(position)->value;
+  }
+
+  /**
+   * @brief Returns the element at the given position.
+   *
+   * @throws std::out_of_range if position is not smaller than size().
+   */
+  T& at(size_t position)
+  {
+    check(position < size());
+    return (*this)[position];
+  }
+
+  const T& at(size_t position) const
+  {
+    check(position < size());
+    return (*this)[position];
+  }
+
+  /**
+   * @brief Inserts value so that it ends up at the given position.
+   *
+   * @throws std::out_of_range if position is greater than size().
+   */
+  void insert(size_t position, T value)
+  {
+    check(position <= size());
+    Node* node   = new Node(move(value), next_priority());
+    auto  halves = split(root_, position);
+    root_        = merge(merge(halves.first, node), halves.second);
+  }
+
+  void push_back(T value)
+  {
+    root_ = merge(root_, new Node(move(value), next_priority()));
+  }
+
+  void push_front(T value)
+  {
+    root_ = merge(new Node(move(value), next_priority()), root_);
+  }
+
+  /**
+   * @brief Removes the element at the given position.
+   *
+   * @throws std::out_of_range if position is not smaller than size().
+   */
+  void erase(size_t position)
+  {
+    erase(position, position + 1);
+  }
+
+  /**
+   * @brief Removes the elements in [first, last).
+   *
+   * @throws std::out_of_range if the range is not inside the sequence.
+   */
+  void erase(size_t first, size_t last)
+  {
+    check(first <= last && last <= size());
+    auto right  = split(root_, last);
+    auto middle = split(right.first, first);
+    destroy(middle.second);
+    root_ = merge(middle.first, right.second);
+  }
+
+  /**
+   * @brief Moves the elements from position onwards into a new sequence.
+   *
+   * @throws std::out_of_range if position is greater than size().
+   * @return IndexedSequence The elements [position, size()).
+   */
+  IndexedSequence split_off(size_t position)
+  {
+    check(position <= size());
+    auto            halves = split(root_, position);
+    IndexedSequence tail;
+    root_      = halves.first;
+    tail.root_ = halves.second;
+    tail.seed_ = seed_ ^ 0x9e3779b97f4a7c15ULL;
+    return tail;
+  }
+
+  /**
+   * @brief Moves every element of other to the end of this sequence.
+   */
+  void concat(IndexedSequence&& other)
+  {
+    root_       = merge(root_, other.root_);
+    other.root_ = nullptr;
+  }
+
+  /**
+   * @brief Calls f on every element in order.
+   */
+  template <typename F>
+  void for_each(F f) const
+  {
+    vector<const Node*> stack;
+    const Node*         node = root_;
+    while (node != nullptr || !stack.empty()) {
+      while (node != nullptr) {
+        stack.push_back(node);
+        node = node->left;
+      }
+      node = stack.back();
+      stack.pop_back();
+      f(node->value);
+      node = node->right;
+    }
+  }
+
+  vector<T> to_vector() const
+  {
+    vector<T> values;
+    values.reserve(size());
+    for_each([&values](const T& value) { values.push_back(value); });
+    return values;
+  }
+
+  void clear()
+  {
+    destroy(root_);
+    root_ = nullptr;
+  }
+
+private:
+  struct Node
+  {
+    T        value;
+    uint64_t priority;
+    size_t   size  = 1;
+    Node*    left  = nullptr;
+    Node*    right = nullptr;
+
+    Node(T v, uint64_t p) : value(move(v)), priority(p)
+    {
+    }
+  };
+
+  static size_t size_of(const Node* node)
+  {
+    return node != nullptr ? node->size : 0;
+  }
+
+  static void update(Node* node)
+  {
+    node->size = 1 + size_of(node->left) + size_of(node->right);
+  }
+
+  static void check(bool condition)
+  {
+    if (!condition) {
+      throw out_of_range("IndexedSequence: position out of range");
+    }
+  }
+
+  uint64_t next_priority()
+  {
+    // xorshift64*
+    seed_ ^= seed_ >> 12;
+    seed_ ^= seed_ << 25;
+    seed_ ^= seed_ >> 27;
+    return seed_ * 0x2545F4914F6CDD1DULL;
+  }
+
+  Node* find(size_t position) const
+  {
+    Node* node = root_;
+    while (true) {
+      size_t left = size_of(node->left);
+      if (position < left) {
+        node = node->left;
+      }
+      else if (position == left) {
+        return node;
+      }
+      else {
+        position -= left + 1;
+        node = node->right;
+      }
+    }
+  }
+
+  /**
+   * @brief Splits a tree into its first count elements and the rest.
+   */
+  static pair<Node*, Node*> split(Node* node, size_t count)
+  {
+    if (node == nullptr) {
+      return {nullptr, nullptr};
+    }
+    if (size_of(node->left) >= count) {
+      auto halves = split(node->left, count);
+      node->left  = halves.second;
+      update(node);
+      return {halves.first, node};
+    }
+    auto halves = split(node->right, count - size_of(node->left) - 1);
+    node->right = halves.first;
+    update(node);
+    return {node, halves.second};
+  }
+
+  /**
+   * @brief Concatenates two trees, keeping the heap order of the priorities.
+   */
+  static Node* merge(Node* a, Node* b)
+  {
+    if (a == nullptr) {
+      return b;
+    }
+    if (b == nullptr) {
+      return a;
+    }
+    if (a->priority > b->priority) {
+      a->right = merge(a->right, b);
+      update(a);
+      return a;
+    }
+    b->left = merge(a, b->left);
+    update(b);
+    return b;
+  }
+
+  static Node* clone(const Node* node)
+  {
+    if (node == nullptr) {
+      return nullptr;
+    }
+    Node* copy  = new Node(node->value, node->priority);
+    copy->size  = node->size;
+    copy->left  = clone(node->left);
+    copy->right = clone(node->right);
+    return copy;
+  }
+
+  static void destroy(Node* node)
+  {
+    vector<Node*> stack;
+    if (node != nullptr) {
+      stack.push_back(node);
+    }
+    while (!stack.empty()) {
+      Node* current = stack.back();
+      stack.pop_back();
+      if (current->left != nullptr) {
+        stack.push_back(current->left);
+      }
+      if (current->right != nullptr) {
+        stack.push_back(current->right);
+      }
+      delete current;
+    }
+  }
+
+  Node*    root_ = nullptr;
+  uint64_t seed_ = 0x853c49e6748fea9bULL;
+};
+
+/**
+ * @brief Prints the elements of a sequence, in the same format as print_list()
+ * in lists.cpp.
+ */
+void print_sequence(const IndexedSequence<int>& s)
+{
+  cout << "Lista: ";
+  s.for_each([](int elem) { cout << elem << ' '; });
+  cout << '\n';
+}
+
+/**
+ * @brief Same positional operations as the Insert and Remove options of
+ * lists.cpp, plus split and concatenation.
+ */
+void basic_indexed_sequence()
+{
+  IndexedSequence<int> s = {10, 20, 30, 40, 50};
+  print_sequence(s);
+
+  s.insert(2, 25);
+  s.push_front(5);
+  print_sequence(s);
+
+  s.erase(3);
+  cout << "Element at position 3: " << s.at(3) << '\n';
+
+  IndexedSequence<int> tail = s.split_off(4);
+  print_sequence(s);
+  print_sequence(tail);
+
+  tail.concat(move(s));
+  print_sequence(tail);
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Applies the same random positional inserts and erases to a
+ * std::list (with advance()), a std::vector and an IndexedSequence.
+ *
+ * @param n   Initial number of elements.
+ * @param ops Number of positional edits.
+ * @return bool True if the three containers end with the same contents.
+ */
+bool benchmark(size_t n, size_t ops)
+{
+  vector<int> initial(n);
+  for (size_t i = 0; i < n; ++i) {
+    initial[i] = static_cast<int>(i);
+  }
+  // Pre-computed edits: even steps insert, odd steps erase
+  mt19937_64     rng(11);
+  vector<size_t> positions(ops);
+  size_t         current = n;
+  for (size_t i = 0; i < ops; ++i) {
+    positions[i] = i % 2 == 0 ? rng() % (current + 1) : rng() % current;
+    current = i % 2 == 0 ? current + 1 : current - 1;
+  }
+
+  list<int>            l(initial.begin(), initial.end());
+  vector<int>          v(initial);
+  IndexedSequence<int> s;
+
+  cout << "\nBenchmark: " << ops << " positional edits on " << n << " elements" << '\n';
+  cout << "IndexedSequence build: " << time_ms([&] { s = IndexedSequence<int>(initial.begin(), initial.end()); }) << " ms\n";
+  cout << "list + advance:  " << time_ms([&] {
+    for (size_t i = 0; i < ops; ++i) {
+      auto it = l.begin();
+      advance(it, positions[i]);
+      if (i % 2 == 0) {
+        l.insert(it, -static_cast<int>(i));
+      }
+      else {
+        l.erase(it);
+      }
+    }
+  }) << " ms\n";
+  cout << "vector:          " << time_ms([&] {
+    for (size_t i = 0; i < ops; ++i) {
+      auto it = v.begin() + static_cast<ptrdiff_t>(positions[i]);
+      if (i % 2 == 0) {
+        v.insert(it, -static_cast<int>(i));
+      }
+      else {
+        v.erase(it);
+      }
+    }
+  }) << " ms\n";
+  cout << "IndexedSequence: " << time_ms([&] {
+    for (size_t i = 0; i < ops; ++i) {
+      if (i % 2 == 0) {
+        s.insert(positions[i], -static_cast<int>(i));
+      }
+      else {
+        s.erase(positions[i]);
+      }
+    }
+  }) << " ms\n";
+
+  vector<int> result = s.to_vector();
+  return result == v && equal(l.begin(), l.end(), v.begin(), v.end());
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The initial number of elements and the number of edits of the benchmark can
+ * be passed as the first and second arguments.
+ *
+ * @return int Returns 0 if the three containers end with the same contents.
+ */
+int main(int argc, char* argv[])
+{
+  basic_indexed_sequence();
+
+  size_t n   = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+  size_t ops = argc > 2 ? strtoull(argv[2], nullptr, 10) : 2000;
+  bool   ok  = benchmark(n, ops);
+  cout << "Same contents: " << (ok ? "yes" : "no") << '\n';
+
+  return ok ? 0 : 1;
+}
@@ -1,3 +1,5 @@
+#include "allocation_tracker.h"
+#include "range_formatter.h"
 #include <conio.h>
 #include <iostream>
 #include <list>
@@ -7,11 +9,9 @@ using namespace std;
 // Función para imprimir los elementos de una lista
 void print_list(const list<int>& l)
 {
-  cout << "Lista: ";
-  for (const auto& elem : l) {
-    cout << elem << ' ';
-  }
-  cout << '\n';
+  RangeFormatter& out = console_formatter();
+  out.write("Lista: ").write(l).put('\n');
+  out.flush();
 }
 
 void show_menu(const string options[], int num_options, int selection)
@@ -37,6 +37,7 @@ void wait_for_enter()
 
 void push_back(list<int>& l)
 {
+  ALLOCATION_SCOPE("push_back");
   // ask for a number to add to the list
   int number;
   cout << "Enter a number to add to the list: ";
@@ -0,0 +1,621 @@
+/**
+ * @file map_snapshot.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Binary snapshot of the map of maps.cpp, loaded with mmap and read in
+ * place.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Rebuilding a large map entry by entry on every start is slow. This program
+ * saves the map as a binary image:
+ *
+ *   - a header: magic, version, byte order mark, sizes and offsets;
+ *   - the entries, sorted by key, as fixed-size records;
+ *   - a string heap with the names and addresses, each distinct string once.
+ *
+ * The image holds offsets instead of pointers, so it can be mapped at any
+ * address. Opening it only maps the file and checks the header: lookups are
+ * binary searches over the mapped records. SnapshotMap answers reads from the
+ * mapping and copies it into a std::map the first time it is modified.
+ *
+ * The file is mapped with mmap on POSIX systems and with MapViewOfFile on
+ * Windows.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "custom_types.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+using CustomMap = map<CustomKey, CustomValue>;
+
+/**
+ * @brief Layout of the snapshot file. Every offset is counted from the start
+ * of the file, and every string offset from the start of the string heap.
+ */
+namespace snapshot_format
+{
+constexpr char     magic[8]   = {'C', 'K', 'V', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t version    = 1;
+constexpr uint32_t byte_order = 0x01020304; // Reads differently on a machine with another byte order
+
+struct Header
+{
+  char     magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t count;          // Number of entries
+  uint64_t entries_offset; // Offset of the first Entry
+  uint64_t strings_offset; // Offset of the string heap
+  uint64_t strings_size;   // Size of the string heap in bytes
+};
+
+struct Entry
+{
+  int32_t  id;
+  int32_t  age;
+  uint32_t name_offset;
+  uint32_t name_length;
+  uint32_t address_offset;
+  uint32_t address_length;
+};
+
+static_assert(sizeof(Header) == 48, "Header must have no padding");
+static_assert(sizeof(Entry) == 24, "Entry must have no padding");
+} // namespace snapshot_format
+
+/**
+ * @brief One entry of a snapshot. The strings point into the mapped file.
+ */
+struct EntryView
+{
+  int         id;
+  string_view name;
+  int         age;
+  string_view address;
+};
+
+/**
+ * @brief Writes m to path as a snapshot image.
+ *
+ * The image is written to path + ".tmp" and then renamed, so a reader never
+ * sees a half-written file.
+ *
+ * @throws runtime_error If the file cannot be written.
+ */
+void save_snapshot(const CustomMap& m, const string& path)
+{
+  using namespace snapshot_format;
+
+  string                               strings;
+  unordered_map<string_view, uint32_t> offsets; // Keys point into the map, which outlives this function
+  auto intern = [&](const string& text) {
+    auto found = offsets.find(text);
+    if (found != offsets.end()) {
+      return found->second;
+    }
+    if (strings.size() + text.size() > UINT32_MAX) {
+      throw runtime_error("Snapshot string heap exceeds 4 GiB");
+    }
+    auto offset = static_cast<uint32_t>(strings.size());
+    strings += text;
+    offsets.emplace(text, offset);
+    return offset;
+  };
+
+  vector<Entry> entries;
+  entries.reserve(m.size());
+  for (const auto& [key, value] : m) { // Already sorted by key
+    Entry entry;
+    entry.id             = key.id;
+    entry.age            = value.age;
+    entry.name_offset    = intern(key.name);
+    entry.name_length    = static_cast<uint32_t>(key.name.size());
+    entry.address_offset = intern(value.address);
+    entry.address_length = static_cast<uint32_t>(value.address.size());
+    entries.push_back(entry);
+  }
+
+  Header header;
+  memcpy(header.magic, magic, sizeof(magic));
+  header.version        = version;
+  header.byte_order     = byte_order;
+  header.count          = entries.size();
+  header.entries_offset = sizeof(Header);
+  header.strings_offset = header.entries_offset + entries.size() * sizeof(Entry);
+  header.strings_size   = strings.size();
+
+  string   temporary = path + ".tmp";
+  ofstream file(temporary, ios::binary | ios::trunc);
+  if (!file.is_open()) {
+    throw runtime_error("Could not open file " + temporary);
+  }
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(entries.data()), static_cast<streamsize>(entries.size() * sizeof(Entry)));
+  file.write(strings.data(), static_cast<streamsize>(strings.size()));
+  file.close();
+  if (!file) {
+    throw runtime_error("Could not write file " + temporary);
+  }
+#ifdef _WIN32
+  bool replaced = MoveFileExA(temporary.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+  bool replaced = rename(temporary.c_str(), path.c_str()) == 0;
+#endif
+  if (!replaced) {
+    throw runtime_error("Could not replace file " + path);
+  }
+}
+
+/**
+ * @brief Read-only mapping of a whole file.
+ */
+class MappedFile
+{
+public:
+  /**
+   * @throws runtime_error If the file cannot be opened or mapped.
+   */
+  explicit MappedFile(const string& path)
+  {
+#ifdef _WIN32
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+      throw runtime_error("Could not open file " + path);
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file_, &size);
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ != 0) {
+      mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      data_    = mapping_ ? static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+      if (data_ == nullptr) {
+        release();
+        throw runtime_error("Could not map file " + path);
+      }
+    }
+#else
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+      throw runtime_error("Could not open file " + path);
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) != 0) {
+      close(descriptor);
+      throw runtime_error("Could not read the size of file " + path);
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ != 0) {
+      void* address = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor, 0);
+      if (address == MAP_FAILED) {
+        close(descriptor);
+        throw runtime_error("Could not map file " + path);
+      }
+      data_ = static_cast<const char*>(address);
+    }
+    close(descriptor); // The mapping stays valid after closing the descriptor
+#endif
+  }
+
+  MappedFile(const MappedFile&)            = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  ~MappedFile()
+  {
+    release();
+  }
+
+  const char* data() const
+  {
+    return data_;
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+private:
+  void release()
+  {
+#ifdef _WIN32
+    if (data_ != nullptr) {
+      UnmapViewOfFile(data_);
+    }
+    if (mapping_ != nullptr) {
+      CloseHandle(mapping_);
+    }
+    if (file_ != INVALID_HANDLE_VALUE) {
+      CloseHandle(file_);
+    }
+#else
+    if (data_ != nullptr) {
+      munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+  }
+
+  const char* data_ = nullptr;
+  size_t      size_ = 0;
+#ifdef _WIN32
+  HANDLE file_    = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+#endif
+};
+
+/**
+ * @brief Snapshot image queried in place.
+ *
+ * Opening checks the header and that the entries and the string heap fit in
+ * the file; each string is checked against the heap when it is read. The
+ * entries are trusted to be sorted, as save_snapshot() writes them.
+ */
+class SnapshotView
+{
+public:
+  /**
+   * @throws runtime_error If the file cannot be mapped or is not a valid
+   * snapshot.
+   */
+  explicit SnapshotView(const string& path) : file_(path)
+  {
+    using namespace snapshot_format;
+
+    if (file_.size() < sizeof(Header)) {
+      throw runtime_error("Snapshot too small: " + path);
+    }
+    memcpy(&header_, file_.data(), sizeof(Header));
+    if (memcmp(header_.magic, magic, sizeof(magic)) != 0 || header_.version != version) {
+      throw runtime_error("Not a snapshot of this version: " + path);
+    }
+    if (header_.byte_order != byte_order) {
+      throw runtime_error("Snapshot written with another byte order: " + path);
+    }
+    uint64_t size = file_.size();
+    if (header_.entries_offset > size || header_.count > (size - header_.entries_offset) / sizeof(Entry) ||
+        header_.strings_offset > size || header_.strings_size > size - header_.strings_offset) {
+      throw runtime_error("Corrupt snapshot: " + path);
+    }
+  }
+
+  size_t size() const
+  {
+    return static_cast<size_t>(header_.count);
+  }
+
+  /**
+   * @brief Returns the entry at position i, in key order.
+   */
+  EntryView operator[](size_t i) const
+  {
+    snapshot_format::Entry entry = record(i);
+    return {entry.id, text(entry.name_offset, entry.name_length), entry.age, text(entry.address_offset, entry.address_length)};
+  }
+
+  /**
+   * @brief Returns the position of the first entry not less than (id, name).
+   */
+  size_t lower_bound(int id, string_view name) const
+  {
+    size_t first = 0, count = size();
+    while (count > 0) {
+      size_t                 half  = count / 2;
+      snapshot_format::Entry entry = record(first + half);
+      if (entry.id < id || (entry.id == id && text(entry.name_offset, entry.name_length) < name)) {
+        first += half + 1;
+        count -= half + 1;
+      }
+      else {
+        count = half;
+      }
+    }
+    return first;
+  }
+
+  optional<EntryView> find(int id, string_view name) const
+  {
+    size_t i = lower_bound(id, name);
+    if (i == size()) {
+      return nullopt;
+    }
+    EntryView entry = (*this)[i];
+    if (entry.id != id || entry.name != name) {
+      return nullopt;
+    }
+    return entry;
+  }
+
+  /**
+   * @brief Returns the first entry (in key order) with the given id.
+   */
+  optional<EntryView> find_id(int id) const
+  {
+    size_t i = lower_bound(id, string_view());
+    if (i == size() || record(i).id != id) {
+      return nullopt;
+    }
+    return (*this)[i];
+  }
+
+private:
+  snapshot_format::Entry record(size_t i) const
+  {
+    snapshot_format::Entry entry; // Copied out: the mapping gives no alignment guarantee for a type
+    memcpy(&entry, file_.data() + header_.entries_offset + i * sizeof(entry), sizeof(entry));
+    return entry;
+  }
+
+  string_view text(uint32_t offset, uint32_t length) const
+  {
+    if (uint64_t(offset) + length > header_.strings_size) {
+      throw runtime_error("Corrupt snapshot: string out of bounds");
+    }
+    return string_view(file_.data() + header_.strings_offset + offset, length);
+  }
+
+  MappedFile              file_;
+  snapshot_format::Header header_;
+};
+
+/**
+ * @brief Map that starts from a snapshot and becomes a CustomMap when
+ * modified.
+ *
+ * Reads go to the mapped snapshot until the first write. The first write
+ * copies the snapshot into a CustomMap, in key order so each insertion takes
+ * constant time, and releases the mapping.
+ */
+class SnapshotMap
+{
+public:
+  explicit SnapshotMap(const string& path) : snapshot_(make_unique<SnapshotView>(path))
+  {
+  }
+
+  bool materialized() const
+  {
+    return snapshot_ == nullptr;
+  }
+
+  size_t size() const
+  {
+    return snapshot_ ? snapshot_->size() : map_.size();
+  }
+
+  optional<EntryView> find(int id, string_view name) const
+  {
+    if (snapshot_) {
+      return snapshot_->find(id, name);
+    }
+    auto it = map_.find(CustomKey(id, string(name)));
+    if (it == map_.end()) {
+      return nullopt;
+    }
+    return view(*it);
+  }
+
+  optional<EntryView> find_id(int id) const
+  {
+    if (snapshot_) {
+      return snapshot_->find_id(id);
+    }
+    auto it = map_.lower_bound(CustomKey(id, ""));
+    if (it == map_.end() || it->first.id != id) {
+      return nullopt;
+    }
+    return view(*it);
+  }
+
+  /**
+   * @brief Calls f with an EntryView of every entry, in key order.
+   */
+  template <typename F>
+  void for_each(F f) const
+  {
+    if (snapshot_) {
+      for (size_t i = 0; i < snapshot_->size(); ++i) {
+        f((*snapshot_)[i]);
+      }
+    }
+    else {
+      for (const auto& entry : map_) {
+        f(view(entry));
+      }
+    }
+  }
+
+  /**
+   * @brief Returns the map to modify, copying the snapshot into it first if
+   * needed.
+   */
+  CustomMap& mutable_map()
+  {
+    if (snapshot_) {
+      for (size_t i = 0; i < snapshot_->size(); ++i) {
+        EntryView entry = (*snapshot_)[i];
+        map_.emplace_hint(map_.end(), piecewise_construct, forward_as_tuple(entry.id, string(entry.name)),
+                          forward_as_tuple(entry.age, string(entry.address)));
+      }
+      snapshot_.reset();
+    }
+    return map_;
+  }
+
+  void save(const string& path)
+  {
+    save_snapshot(mutable_map(), path);
+  }
+
+private:
+  static EntryView view(const CustomMap::value_type& entry)
+  {
+    return {entry.first.id, entry.first.name, entry.second.age, entry.second.address};
+  }
+
+  unique_ptr<SnapshotView> snapshot_;
+  CustomMap                map_;
+};
+
+/**
+ * @brief Prints the entries of the map, in the same format as print_map() in
+ * maps.cpp.
+ */
+void print_map(const SnapshotMap& m)
+{
+  m.for_each([](const EntryView& entry) {
+    cout << "Name: " << entry.name << " ID(" << entry.id << ") -> Age: " << entry.age << ", Address: " << entry.address << '\n';
+  });
+}
+
+/**
+ * @brief Saves the predefined map of maps.cpp, loads it back and modifies it.
+ */
+void basic_snapshot(const string& path)
+{
+  CustomMap m;
+  // Predefine
+  m[CustomKey(1, "Alice")]   = CustomValue(25, "123 Main St");
+  m[CustomKey(2, "Bob")]     = CustomValue(30, "456 Elm St");
+  m[CustomKey(3, "Charlie")] = CustomValue(35, "789 Oak St");
+  save_snapshot(m, path);
+
+  SnapshotMap loaded(path);
+  print_map(loaded);
+  if (auto entry = loaded.find_id(2)) {
+    cout << "Found ID: 2 Name: " << entry->name << " -> Age: " << entry->age << " (materialized: " << loaded.materialized() << ")\n";
+  }
+
+  loaded.mutable_map()[CustomKey(4, "Dave")] = CustomValue(40, "12 Pine St");
+  cout << "After an insert (materialized: " << loaded.materialized() << "):\n";
+  print_map(loaded);
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Compares rebuilding a map entry by entry with loading its snapshot.
+ *
+ * @param n    Number of entries.
+ * @param path File used for the snapshot; it is removed at the end.
+ * @return bool True if the snapshot and the materialized map match the
+ * original map.
+ */
+bool benchmark(size_t n, const string& path)
+{
+  mt19937                              rng(42);
+  vector<pair<CustomKey, CustomValue>> source;
+  source.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    int id = static_cast<int>(rng() % (n / 4 + 1));
+    source.emplace_back(CustomKey(id, "name-" + to_string(rng() % 5000)), CustomValue(id % 100, "Street " + to_string(rng() % 1000)));
+  }
+
+  cout << "\nBenchmark with " << n << " entries" << '\n';
+
+  CustomMap original;
+  cout << "rebuild by insertion: " << time_ms([&] {
+    for (const auto& entry : source) {
+      original.insert_or_assign(entry.first, entry.second);
+    }
+  }) << " ms\n";
+  cout << "save snapshot:        " << time_ms([&] { save_snapshot(original, path); }) << " ms\n";
+
+  optional<SnapshotMap> loaded;
+  cout << "open snapshot:        " << time_ms([&] { loaded.emplace(path); }) << " ms\n";
+
+  long long map_sum = 0, snapshot_sum = 0;
+  cout << "lookups  map: " << time_ms([&] {
+    for (const auto& entry : source) {
+      map_sum += original.find(entry.first)->second.age;
+    }
+  }) << " ms, snapshot: " << time_ms([&] {
+    for (const auto& entry : source) {
+      snapshot_sum += loaded->find(entry.first.id, entry.first.name)->age;
+    }
+  }) << " ms\n";
+
+  bool same = map_sum == snapshot_sum && loaded->size() == original.size();
+  auto it   = original.begin();
+  loaded->for_each([&](const EntryView& entry) {
+    same = same && it != original.end() && entry.id == it->first.id && entry.name == it->first.name && entry.age == it->second.age &&
+           entry.address == it->second.address;
+    ++it;
+  });
+
+  cout << "materialize on write: " << time_ms([&] { loaded->mutable_map(); }) << " ms\n";
+  same = same && loaded->materialized() && loaded->size() == original.size();
+  it   = original.begin();
+  loaded->for_each([&](const EntryView& entry) {
+    same = same && entry.id == it->first.id && entry.name == it->first.name && entry.address == it->second.address;
+    ++it;
+  });
+
+  loaded.reset();
+  remove(path.c_str());
+  return same;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of entries and the snapshot file can be passed as the first and
+ * second arguments.
+ *
+ * @return int Returns 0 if the snapshot matches the map it was saved from.
+ */
+int main(int argc, char* argv[])
+{
+  size_t n    = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+  string path = argc > 2 ? argv[2] : "map_snapshot.bin";
+
+  try {
+    basic_snapshot(path);
+    bool ok = benchmark(n, path);
+    cout << "Same results: " << (ok ? "yes" : "no") << '\n';
+    return ok ? 0 : 1;
+  }
+  catch (const exception& e) {
+    cout << "Error: " << e.what() << '\n';
+    return 1;
+  }
+}
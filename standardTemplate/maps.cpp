@@ -1,55 +1,33 @@
+#include "allocation_tracker.h"
+#include "custom_map.h"
+#include "range_formatter.h"
 #include <conio.h>
 #include <iostream>
 #include <map>
 #include <string>
+#include <utility>
 
 using namespace std;
 
-// Custom class to use as a key in the map
-class CustomKey
-{
-public:
-  int    id;
-  string name;
-
-  CustomKey(int id, string name) : id(id), name(name)
-  {
-  }
-
-  bool operator<(const CustomKey& other) const
-  {
-    if (id == other.id) {
-      return name < other.name;
-    }
-    else {
-      return id < other.id;
-    }
-  }
-};
-
-// Custom class to use as a value in the map
-class CustomValue
-{
-public:
-  int    age;
-  string address;
-
-  CustomValue() : age(0), address("")
-  {
-  } // Default constructor
-
-  CustomValue(int age, string address) : age(age), address(address)
-  {
-  }
-};
-
 // Function to print the elements of the map
 template <typename K, typename V>
 void print_map(const map<K, V>& m)
 {
-  for (const auto& pair : m) {
-    cout << "Name: " << pair.first.name << " ID(" << pair.first.id << ") -> Age: " << pair.second.age << ", Address: " << pair.second.address << endl;
-  }
+  RangeFormatter& out = console_formatter();
+  out.write_range(
+    m,
+    [](RangeFormatter& f, const auto& pair) {
+      f.write("Name: ").write(pair.first.name).write(" ID(").write(pair.first.id).write(") -> Age: ").write(pair.second.age);
+      f.write(", Address: ").write(pair.second.address);
+    },
+    "\n");
+  out.flush();
+}
+
+template <typename K, typename V, typename IdOf>
+void print_map(const IndexedMap<K, V, IdOf>& m)
+{
+  print_map(m.primary());
 }
 
 void show_menu(const string options[], int num_options, int selection)
@@ -73,8 +51,9 @@ void wait_for_enter()
   cin.get();
 }
 
-void insert(map<CustomKey, CustomValue>& m)
+void insert(CustomMap& m)
 {
+  ALLOCATION_SCOPE("insert");
   int    id, age;
   string name, address;
 
@@ -88,78 +67,70 @@ void insert(map<CustomKey, CustomValue>& m)
   cout << "Enter address: ";
   std::getline(std::cin, address);
 
-  CustomKey   key(id, name);
-  CustomValue value(age, address);
-  m[key] = value;
+  m.insert_or_assign(CustomKey(id, move(name)), CustomValue(age, move(address)));
 
   print_map(m);
 }
 
-void modify(map<CustomKey, CustomValue>& m)
+void modify(CustomMap& m)
 {
   int id;
   cout << "Enter the ID of the key to modify: ";
   cin >> id;
 
-  for (auto& pair : m) {
-    if (pair.first.id == id) {
-      int    age;
-      string address;
+  auto it = m.find_id(id);
+  if (it != m.end()) {
+    int    age;
+    string address;
 
-      cout << "Enter new age: ";
-      cin >> age;
-      cin.ignore();
-      cout << "Enter new address: ";
-      std::getline(std::cin, address);
+    cout << "Enter new age: ";
+    cin >> age;
+    cin.ignore();
+    cout << "Enter new address: ";
+    std::getline(std::cin, address);
 
-      pair.second.age     = age;
-      pair.second.address = address;
-      break;
-    }
+    it->second.age     = age;
+    it->second.address = move(address);
   }
   print_map(m);
 }
 
-void remove(map<CustomKey, CustomValue>& m)
+void remove(CustomMap& m)
 {
   int id;
   cout << "Enter the ID of the key to remove: ";
   cin >> id;
 
-  for (auto it = m.begin(); it != m.end(); ++it) {
-    if (it->first.id == id) {
-      m.erase(it);
-      break;
-    }
+  auto it = m.find_id(id);
+  if (it != m.end()) {
+    m.erase(it);
   }
 
   print_map(m);
 }
 
-void find(const map<CustomKey, CustomValue>& m)
+void find(const CustomMap& m)
 {
   int id;
   cout << "Enter the ID of the key to find: ";
   cin >> id;
 
-  for (const auto& pair : m) {
-    if (pair.first.id == id) {
-      cout << "Found ID: " << pair.first.id << " Name: " << pair.first.name << " -> Age: " << pair.second.age << ", Address: " << pair.second.address
-           << endl;
-      return;
-    }
+  auto it = m.find_id(id);
+  if (it != m.end()) {
+    cout << "Found ID: " << it->first.id << " Name: " << it->first.name << " -> Age: " << it->second.age << ", Address: " << it->second.address << endl;
+    return;
   }
 
   cout << "Key not found" << endl;
 }
 
-void clear(map<CustomKey, CustomValue>& m)
+void clear(CustomMap& m)
 {
   m.clear();
   print_map(m);
 }
 
-void empty(const map<CustomKey, CustomValue>& m)
+void empty(const CustomMap& m)
 {
   if (m.empty()) {
     cout << "The map is empty" << endl;
@@ -169,14 +140,14 @@ void empty(const map<CustomKey, CustomValue>& m)
   }
 }
 
-void map_size(const map<CustomKey, CustomValue>& m)
+void map_size(const CustomMap& m)
 {
   cout << "The size of the map is: " << m.size() << endl;
 }
 
 int main()
 {
-  map<CustomKey, CustomValue> myMap;
+  CustomMap myMap;
 
   const int numOptions          = 9;
   string    options[numOptions] = {"Insert", "Modify", "Remove", "Find", "Clear", "Empty", "Size", "Predefine", "Exit"};
@@ -226,17 +197,9 @@ int main()
         wait_for_enter();
       }
       else if (options[selection] == "Predefine") {
-        CustomKey   key1(1, "Alice");
-        CustomValue value1(25, "123 Main St");
-        myMap[key1] = value1;
-
-        CustomKey   key2(2, "Bob");
-        CustomValue value2(30, "456 Elm St");
-        myMap[key2] = value2;
-
-        CustomKey   key3(3, "Charlie");
-        CustomValue value3(35, "789 Oak St");
-        myMap[key3] = value3;
+        myMap.bulk_load({{CustomKey(1, "Alice"), CustomValue(25, "123 Main St")},
+                         {CustomKey(2, "Bob"), CustomValue(30, "456 Elm St")},
+                         {CustomKey(3, "Charlie"), CustomValue(35, "789 Oak St")}});
 
         print_map(myMap);
         wait_for_enter();
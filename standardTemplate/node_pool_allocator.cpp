@@ -0,0 +1,338 @@
+/**
+ * @file node_pool_allocator.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Pool allocator for the nodes of std::list.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Every push_back, push_front and insert on a std::list<int> allocates one
+ * small node with operator new, and the nodes end up spread over the heap.
+ * NodePoolAllocator carves nodes out of large slabs and recycles freed nodes
+ * through a free list. Each thread keeps a small cache of free nodes, so the
+ * shared pool (and its mutex) is only touched once every few hundred
+ * allocations.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Process-wide pool of fixed-size blocks, with a per-thread cache.
+ *
+ * Free blocks travel between the threads and the shared pool in batches of
+ * batch_size blocks linked through their first word, so moving a batch is
+ * O(1) and the shared mutex is taken once per batch. Each thread caches at
+ * most two batches.
+ *
+ * The pool is created on first use and never destroyed, so nodes can be
+ * freed safely even while static objects are being destroyed at exit. The
+ * slabs are released by the operating system when the process ends.
+ *
+ * @tparam Size  Size of a block in bytes.
+ * @tparam Align Alignment of a block.
+ */
+template <size_t Size, size_t Align>
+class NodePool
+{
+public:
+  static NodePool& instance()
+  {
+    static NodePool* pool = new NodePool;
+    return *pool;
+  }
+
+  /**
+   * @brief Returns one block, taking it from the calling thread's cache.
+   */
+  void* allocate()
+  {
+    Cache& cache = thread_cache();
+    if (cache.active.head == nullptr) {
+      if (cache.full.head != nullptr) {
+        cache.active = cache.full;
+        cache.full   = Batch();
+      }
+      else {
+        cache.active = take_batch();
+      }
+    }
+    FreeBlock* block  = cache.active.head;
+    cache.active.head = block->next;
+    --cache.active.count;
+    return block;
+  }
+
+  /**
+   * @brief Returns a block to the calling thread's cache. When the cache
+   * already holds two full batches, one of them goes back to the shared pool.
+   */
+  void deallocate(void* p)
+  {
+    Cache& cache      = thread_cache();
+    auto*  block      = static_cast<FreeBlock*>(p);
+    block->next       = cache.active.head;
+    cache.active.head = block;
+    if (++cache.active.count == batch_size) {
+      if (cache.full.head != nullptr) {
+        give_batch(cache.full);
+      }
+      cache.full   = cache.active;
+      cache.active = Batch();
+    }
+  }
+
+private:
+  struct FreeBlock
+  {
+    FreeBlock* next;
+  };
+
+  /**
+   * @brief Null-terminated chain of free blocks.
+   */
+  struct Batch
+  {
+    FreeBlock* head  = nullptr;
+    size_t     count = 0;
+  };
+
+  static constexpr size_t block_align = max(Align, alignof(FreeBlock));
+  static constexpr size_t block_size  = (max(Size, sizeof(FreeBlock)) + block_align - 1) / block_align * block_align;
+  static constexpr size_t batch_size  = 256;  // Blocks moved between a thread cache and the pool at once
+  static constexpr size_t slab_blocks = 4096; // Blocks per slab, a multiple of batch_size
+
+  /**
+   * @brief Free blocks owned by one thread. They go back to the pool when
+   * the thread exits.
+   */
+  struct Cache
+  {
+    Batch active;
+    Batch full;
+
+    ~Cache()
+    {
+      NodePool& pool = NodePool::instance();
+      if (active.head != nullptr) {
+        pool.give_batch(active);
+      }
+      if (full.head != nullptr) {
+        pool.give_batch(full);
+      }
+    }
+  };
+
+  static Cache& thread_cache()
+  {
+    thread_local Cache cache;
+    return cache;
+  }
+
+  /**
+   * @brief Takes a batch from the shared pool, carving a new slab into
+   * batches when the pool is empty.
+   */
+  Batch take_batch()
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (batches_.empty()) {
+      char* slab = static_cast<char*>(::operator new(block_size * slab_blocks, align_val_t(block_align)));
+      // Link each batch in address order, so a fresh list walks memory forwards
+      for (size_t first = slab_blocks; first > 0;) {
+        first -= batch_size;
+        Batch batch{reinterpret_cast<FreeBlock*>(slab + first * block_size), batch_size};
+        for (size_t i = first; i < first + batch_size; ++i) {
+          reinterpret_cast<FreeBlock*>(slab + i * block_size)->next =
+            i + 1 < first + batch_size ? reinterpret_cast<FreeBlock*>(slab + (i + 1) * block_size) : nullptr;
+        }
+        batches_.push_back(batch);
+      }
+    }
+    Batch batch = batches_.back();
+    batches_.pop_back();
+    return batch;
+  }
+
+  void give_batch(const Batch& batch)
+  {
+    lock_guard<mutex> lock(mutex_);
+    batches_.push_back(batch);
+  }
+
+  NodePool() = default;
+
+  mutex         mutex_;
+  vector<Batch> batches_;
+};
+
+/**
+ * @brief Standard allocator that serves single-object requests, such as the
+ * nodes of std::list, std::map or std::set, from a NodePool.
+ *
+ * Requests for more than one object go to operator new. The allocator is
+ * stateless, so any two instances are interchangeable (list::splice works
+ * between lists that use it).
+ */
+template <typename T>
+class NodePoolAllocator
+{
+public:
+  using value_type = T;
+
+  NodePoolAllocator() noexcept = default;
+
+  template <typename U>
+  NodePoolAllocator(const NodePoolAllocator<U>&) noexcept
+  {
+  }
+
+  T* allocate(size_t n)
+  {
+    if (n == 1) {
+      return static_cast<T*>(NodePool<sizeof(T), alignof(T)>::instance().allocate());
+    }
+    return static_cast<T*>(::operator new(n * sizeof(T), align_val_t(alignof(T))));
+  }
+
+  void deallocate(T* p, size_t n) noexcept
+  {
+    if (n == 1) {
+      NodePool<sizeof(T), alignof(T)>::instance().deallocate(p);
+      return;
+    }
+    ::operator delete(p, align_val_t(alignof(T)));
+  }
+
+  template <typename U>
+  bool operator==(const NodePoolAllocator<U>&) const noexcept
+  {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const NodePoolAllocator<U>&) const noexcept
+  {
+    return false;
+  }
+};
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Times push, erase and traversal on one list type.
+ *
+ * @param name Label printed before the timings.
+ * @param n    Number of elements pushed.
+ * @return long long Checksum of the traversal, to compare both list types.
+ */
+template <typename List>
+long long benchmark_list(const string& name, size_t n)
+{
+  long long sum = 0;
+  cout << name << '\n';
+  double total = time_ms([&] {
+    List l;
+    cout << "  push_back/push_front: " << time_ms([&] {
+      for (size_t i = 0; i < n; ++i) {
+        if (i % 2 == 0) {
+          l.push_back(static_cast<int>(i));
+        }
+        else {
+          l.push_front(static_cast<int>(i));
+        }
+      }
+    }) << " ms\n";
+
+    cout << "  erase every other:    " << time_ms([&] {
+      bool erase = true;
+      for (auto it = l.begin(); it != l.end(); erase = !erase) {
+        it = erase ? l.erase(it) : next(it);
+      }
+    }) << " ms\n";
+
+    cout << "  insert after each:    " << time_ms([&] {
+      for (auto it = l.begin(); it != l.end(); ++it) {
+        it = l.insert(next(it), *it + 1);
+      }
+    }) << " ms\n";
+
+    cout << "  traversal:            " << time_ms([&] {
+      for (int x : l) {
+        sum += x;
+      }
+    }) << " ms\n";
+  });
+  cout << "  total (with clear):   " << total << " ms\n";
+  return sum;
+}
+
+/**
+ * @brief Builds and destroys lists on several threads at once, to exercise
+ * the per-thread caches.
+ */
+template <typename List>
+double threaded_churn(unsigned num_threads, size_t n)
+{
+  return time_ms([&] {
+    vector<thread> threads;
+    for (unsigned t = 0; t < num_threads; ++t) {
+      threads.emplace_back([n] {
+        for (int round = 0; round < 4; ++round) {
+          List l;
+          for (size_t i = 0; i < n; ++i) {
+            l.push_back(static_cast<int>(i));
+          }
+          l.remove_if([](int x) { return x % 3 == 0; });
+        }
+      });
+    }
+    for (auto& th : threads) {
+      th.join();
+    }
+  });
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * Compares std::list<int> with the default allocator against
+ * std::list<int, NodePoolAllocator<int>>. The number of elements can be
+ * passed as the first argument.
+ *
+ * @return int Returns 0 if both lists produce the same checksum.
+ */
+int main(int argc, char* argv[])
+{
+  size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+
+  long long expected = benchmark_list<list<int>>("list<int>", n);
+  long long pooled   = benchmark_list<list<int, NodePoolAllocator<int>>>("list<int, NodePoolAllocator<int>>", n);
+
+  unsigned num_threads = max(2u, thread::hardware_concurrency());
+  cout << "\n" << num_threads << " threads building and destroying lists" << '\n';
+  cout << "  list<int>:                         " << threaded_churn<list<int>>(num_threads, n / 4) << " ms\n";
+  cout << "  list<int, NodePoolAllocator<int>>: " << threaded_churn<list<int, NodePoolAllocator<int>>>(num_threads, n / 4) << " ms\n";
+
+  cout << "\nChecksums " << (expected == pooled ? "match" : "DIFFER") << '\n';
+  return expected == pooled ? 0 : 1;
+}
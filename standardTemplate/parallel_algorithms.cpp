@@ -0,0 +1,575 @@
+/**
+ * @file parallel_algorithms.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Work-stealing thread pool and parallel sort, transform, reduce and
+ * for_each over std::vector ranges.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Every worker of the pool owns a deque of tasks. A worker pushes and pops
+ * tasks at the back of its own deque (LIFO, cache friendly) and, when it runs
+ * out of work, steals from the front of the other workers' deques (FIFO, the
+ * biggest pieces of work). The algorithms split their input recursively until
+ * a piece is smaller than the grain size, so idle workers always find large
+ * chunks to steal.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Fixed-size pool of worker threads with one task deque per worker.
+ *
+ * Tasks submitted from a worker thread go to the back of that worker's deque.
+ * Tasks submitted from any other thread are distributed round-robin. Tasks
+ * must not let exceptions escape; use TaskGroup to propagate them.
+ */
+class ThreadPool
+{
+public:
+  using Task = function<void()>;
+
+  /**
+   * @brief Starts the worker threads.
+   *
+   * @param num_threads Number of workers. 0 uses the number of hardware threads.
+   */
+  explicit ThreadPool(unsigned num_threads = 0)
+  {
+    if (num_threads == 0) {
+      num_threads = max(1u, thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < num_threads; ++i) {
+      queues_.push_back(make_unique<WorkerQueue>());
+    }
+    for (unsigned i = 0; i < num_threads; ++i) {
+      workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&)            = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Stops the workers after the queued tasks have been executed.
+   */
+  ~ThreadPool()
+  {
+    {
+      lock_guard<mutex> lock(sleep_mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  /**
+   * @brief Returns the number of worker threads.
+   */
+  size_t size() const
+  {
+    return workers_.size();
+  }
+
+  /**
+   * @brief Queues a task for execution.
+   *
+   * @param task The task to run. It must not throw.
+   */
+  void submit(Task task)
+  {
+    size_t index;
+    if (current_pool == this) {
+      index = current_index;
+    }
+    else {
+      index = next_queue_.fetch_add(1, memory_order_relaxed) % queues_.size();
+    }
+    queues_[index]->push_back(move(task));
+    queued_.fetch_add(1, memory_order_release);
+    {
+      // Taking the lock orders this notification after a sleeping worker has
+      // checked its predicate, so the wake-up can not be lost.
+      lock_guard<mutex> lock(sleep_mutex_);
+    }
+    wake_.notify_one();
+  }
+
+  /**
+   * @brief Runs one queued task on the calling thread, if there is any.
+   *
+   * Threads that wait for a group of tasks call this instead of blocking, so
+   * nested parallelism can not deadlock the pool.
+   *
+   * @return true if a task was executed.
+   */
+  bool try_run_one()
+  {
+    Task task;
+    size_t home = current_pool == this ? current_index : 0;
+    if (!take_task(home, task)) {
+      return false;
+    }
+    task();
+    return true;
+  }
+
+private:
+  /**
+   * @brief Task deque owned by one worker. The owner uses the back, thieves
+   * use the front.
+   */
+  struct WorkerQueue
+  {
+    mutex       lock;
+    deque<Task> tasks;
+
+    void push_back(Task task)
+    {
+      lock_guard<mutex> guard(lock);
+      tasks.push_back(move(task));
+    }
+
+    bool pop_back(Task& task)
+    {
+      lock_guard<mutex> guard(lock);
+      if (tasks.empty()) {
+        return false;
+      }
+      task = move(tasks.back());
+      tasks.pop_back();
+      return true;
+    }
+
+    bool steal_front(Task& task)
+    {
+      lock_guard<mutex> guard(lock);
+      if (tasks.empty()) {
+        return false;
+      }
+      task = move(tasks.front());
+      tasks.pop_front();
+      return true;
+    }
+  };
+
+  bool take_task(size_t home, Task& task)
+  {
+    if (queued_.load(memory_order_acquire) == 0) {
+      return false;
+    }
+    bool found = queues_[home]->pop_back(task);
+    for (size_t i = 1; !found && i < queues_.size(); ++i) {
+      found = queues_[(home + i) % queues_.size()]->steal_front(task);
+    }
+    if (found) {
+      queued_.fetch_sub(1, memory_order_relaxed);
+    }
+    return found;
+  }
+
+  void worker_loop(size_t index)
+  {
+    current_pool  = this;
+    current_index = index;
+    Task task;
+    while (true) {
+      if (take_task(index, task)) {
+        task();
+        task = nullptr;
+        continue;
+      }
+      unique_lock<mutex> lock(sleep_mutex_);
+      wake_.wait(lock, [this] { return stop_ || queued_.load(memory_order_acquire) > 0; });
+      if (stop_ && queued_.load(memory_order_acquire) == 0) {
+        return;
+      }
+    }
+  }
+
+  static thread_local ThreadPool* current_pool;
+  static thread_local size_t      current_index;
+
+  vector<unique_ptr<WorkerQueue>> queues_;
+  vector<thread>                  workers_;
+  atomic<size_t>                  queued_{0};
+  atomic<size_t>                  next_queue_{0};
+  mutex                           sleep_mutex_;
+  condition_variable              wake_;
+  bool                            stop_ = false;
+};
+
+thread_local ThreadPool* ThreadPool::current_pool  = nullptr;
+thread_local size_t      ThreadPool::current_index = 0;
+
+/**
+ * @brief Set of tasks that can be waited on as a whole.
+ *
+ * The first exception thrown by a task of the group is rethrown by wait().
+ */
+class TaskGroup
+{
+public:
+  explicit TaskGroup(ThreadPool& pool) : pool_(pool)
+  {
+  }
+
+  /**
+   * @brief Waits for the pending tasks, so none of them outlives the group.
+   */
+  ~TaskGroup()
+  {
+    while (pending_.load(memory_order_acquire) > 0) {
+      if (!pool_.try_run_one()) {
+        this_thread::yield();
+      }
+    }
+  }
+
+  /**
+   * @brief Queues a task that belongs to this group.
+   *
+   * @param f Callable with no arguments.
+   */
+  template <typename F>
+  void run(F&& f)
+  {
+    pending_.fetch_add(1, memory_order_relaxed);
+    pool_.submit([this, f = forward<F>(f)]() mutable {
+      try {
+        f();
+      }
+      catch (...) {
+        lock_guard<mutex> lock(error_mutex_);
+        if (!error_) {
+          error_ = current_exception();
+        }
+      }
+      pending_.fetch_sub(1, memory_order_acq_rel);
+    });
+  }
+
+  /**
+   * @brief Waits until every task of the group has finished, helping the pool
+   * to run queued tasks meanwhile.
+   *
+   * @throws Any exception thrown by one of the tasks.
+   */
+  void wait()
+  {
+    while (pending_.load(memory_order_acquire) > 0) {
+      if (!pool_.try_run_one()) {
+        this_thread::yield();
+      }
+    }
+    if (error_) {
+      exception_ptr error = error_;
+      error_              = nullptr;
+      rethrow_exception(error);
+    }
+  }
+
+private:
+  ThreadPool&    pool_;
+  atomic<size_t> pending_{0};
+  mutex          error_mutex_;
+  exception_ptr  error_;
+};
+
+/**
+ * @brief Picks a grain size when the caller passes 0.
+ *
+ * Aims for about eight pieces per worker so stealing can balance the load,
+ * without making pieces so small that task overhead dominates.
+ *
+ * @param n     Number of elements in the range.
+ * @param pool  The pool that will run the pieces.
+ * @param grain The grain size requested by the caller.
+ * @return size_t The grain size to use, always at least 1.
+ */
+size_t resolve_grain(size_t n, const ThreadPool& pool, size_t grain)
+{
+  if (grain > 0) {
+    return grain;
+  }
+  return max<size_t>(n / (pool.size() * 8), 4096);
+}
+
+/**
+ * @brief Calls body(first, last) on sub-ranges of [first, last) of at most
+ * grain elements, splitting the range recursively in halves.
+ */
+template <typename RandomIt, typename Body>
+void parallel_for_range(TaskGroup& group, RandomIt first, RandomIt last, size_t grain, const Body& body)
+{
+  while (static_cast<size_t>(last - first) > grain) {
+    RandomIt middle = first + (last - first) / 2;
+    group.run([&group, middle, last, grain, &body] { parallel_for_range(group, middle, last, grain, body); });
+    last = middle;
+  }
+  body(first, last);
+}
+
+/**
+ * @brief Applies f to every element of [first, last) in parallel.
+ *
+ * @param pool  The pool that runs the work.
+ * @param first Start of the range.
+ * @param last  End of the range.
+ * @param f     Function called with a reference to each element.
+ * @param grain Maximum number of elements handled by one task, 0 for automatic.
+ */
+template <typename RandomIt, typename F>
+void parallel_for_each(ThreadPool& pool, RandomIt first, RandomIt last, F f, size_t grain = 0)
+{
+  grain = resolve_grain(static_cast<size_t>(last - first), pool, grain);
+  TaskGroup group(pool);
+  parallel_for_range(group, first, last, grain, [&f](RandomIt begin, RandomIt end) { for_each(begin, end, f); });
+  group.wait();
+}
+
+/**
+ * @brief Writes op(x) for every x of [first, last) to the range starting at
+ * d_first, in parallel.
+ *
+ * @param pool    The pool that runs the work.
+ * @param first   Start of the input range.
+ * @param last    End of the input range.
+ * @param d_first Start of the output range, which must hold last - first elements.
+ * @param op      Unary operation.
+ * @param grain   Maximum number of elements handled by one task, 0 for automatic.
+ * @return OutIt Iterator past the last written element.
+ */
+template <typename RandomIt, typename OutIt, typename UnaryOp>
+OutIt parallel_transform(ThreadPool& pool, RandomIt first, RandomIt last, OutIt d_first, UnaryOp op, size_t grain = 0)
+{
+  grain = resolve_grain(static_cast<size_t>(last - first), pool, grain);
+  TaskGroup group(pool);
+  parallel_for_range(group, first, last, grain,
+                     [first, d_first, &op](RandomIt begin, RandomIt end) { transform(begin, end, d_first + (begin - first), op); });
+  group.wait();
+  return d_first + (last - first);
+}
+
+/**
+ * @brief Reduces [first, last) with op, in parallel.
+ *
+ * Each task reduces one piece serially and the partial results are combined
+ * in order, so op only needs to be associative, not commutative.
+ *
+ * @param pool  The pool that runs the work.
+ * @param first Start of the range.
+ * @param last  End of the range.
+ * @param init  Initial value, combined once with the result.
+ * @param op    Associative binary operation.
+ * @param grain Maximum number of elements handled by one task, 0 for automatic.
+ * @return T The reduction of init and every element.
+ */
+template <typename RandomIt, typename T, typename BinaryOp = plus<>>
+T parallel_reduce(ThreadPool& pool, RandomIt first, RandomIt last, T init, BinaryOp op = BinaryOp(), size_t grain = 0)
+{
+  size_t n = static_cast<size_t>(last - first);
+  if (n == 0) {
+    return init;
+  }
+  grain             = resolve_grain(n, pool, grain);
+  size_t num_pieces = (n + grain - 1) / grain;
+
+  // Each piece starts from its own first element, so op needs no neutral element.
+  vector<T> partial(num_pieces, init);
+  TaskGroup group(pool);
+  for (size_t piece = 0; piece < num_pieces; ++piece) {
+    group.run([&, piece] {
+      RandomIt begin = first + static_cast<ptrdiff_t>(piece * grain);
+      RandomIt end   = first + static_cast<ptrdiff_t>(min(n, (piece + 1) * grain));
+      T        acc   = *begin;
+      for (++begin; begin != end; ++begin) {
+        acc = op(move(acc), *begin);
+      }
+      partial[piece] = move(acc);
+    });
+  }
+  group.wait();
+
+  T result = move(init);
+  for (auto& value : partial) {
+    result = op(move(result), move(value));
+  }
+  return result;
+}
+
+/**
+ * @brief Merges the sorted ranges [first1, last1) and [first2, last2) into
+ * out, splitting the work recursively around the median of the larger range.
+ */
+template <typename It, typename OutIt, typename Compare>
+void parallel_merge(TaskGroup& group, It first1, It last1, It first2, It last2, OutIt out, Compare comp, size_t grain)
+{
+  // A split needs two elements in the larger range, or one of the halves is
+  // the whole merge again
+  while (static_cast<size_t>((last1 - first1) + (last2 - first2)) > grain && max(last1 - first1, last2 - first2) >= 2) {
+    It middle1, middle2;
+    if (last1 - first1 >= last2 - first2) {
+      middle1 = first1 + (last1 - first1) / 2;
+      middle2 = lower_bound(first2, last2, *middle1, comp);
+    }
+    else {
+      middle2 = first2 + (last2 - first2) / 2;
+      middle1 = upper_bound(first1, last1, *middle2, comp);
+    }
+    OutIt out_middle = out + (middle1 - first1) + (middle2 - first2);
+    group.run([&group, middle1, last1, middle2, last2, out_middle, comp, grain] {
+      parallel_merge(group, middle1, last1, middle2, last2, out_middle, comp, grain);
+    });
+    last1 = middle1;
+    last2 = middle2;
+  }
+  merge(make_move_iterator(first1), make_move_iterator(last1), make_move_iterator(first2), make_move_iterator(last2), out, comp);
+}
+
+/**
+ * @brief Sorts [first, last) and leaves the result in data when to_buffer is
+ * false, or in buffer when it is true.
+ */
+template <typename It, typename BufIt, typename Compare>
+void parallel_merge_sort(ThreadPool& pool, It data, BufIt buffer, size_t n, bool to_buffer, Compare comp, size_t grain)
+{
+  if (n <= grain) {
+    sort(data, data + static_cast<ptrdiff_t>(n), comp);
+    if (to_buffer) {
+      move(data, data + static_cast<ptrdiff_t>(n), buffer);
+    }
+    return;
+  }
+  size_t half = n / 2;
+  auto   mid  = static_cast<ptrdiff_t>(half);
+  auto   end  = static_cast<ptrdiff_t>(n);
+  {
+    TaskGroup group(pool);
+    group.run([&] { parallel_merge_sort(pool, data, buffer, half, !to_buffer, comp, grain); });
+    parallel_merge_sort(pool, data + mid, buffer + mid, n - half, !to_buffer, comp, grain);
+    group.wait();
+  }
+  TaskGroup group(pool);
+  if (to_buffer) {
+    parallel_merge(group, data, data + mid, data + mid, data + end, buffer, comp, grain);
+  }
+  else {
+    parallel_merge(group, buffer, buffer + mid, buffer + mid, buffer + end, data, comp, grain);
+  }
+  group.wait();
+}
+
+/**
+ * @brief Sorts [first, last) in parallel with a merge sort.
+ *
+ * Pieces of at most grain elements are sorted with std::sort, then merged in
+ * parallel through a temporary buffer of the same size as the range. Like
+ * std::sort, it does not keep the order of equal elements.
+ *
+ * The merge passes only pay off when they run on several cores: with a
+ * single worker, or a range of at most grain elements, it calls std::sort
+ * directly.
+ *
+ * @param pool  The pool that runs the work.
+ * @param first Start of the range.
+ * @param last  End of the range.
+ * @param comp  Strict weak ordering.
+ * @param grain Maximum number of elements handled by one task, 0 for automatic.
+ */
+template <typename RandomIt, typename Compare = less<>>
+void parallel_sort(ThreadPool& pool, RandomIt first, RandomIt last, Compare comp = Compare(), size_t grain = 0)
+{
+  size_t n = static_cast<size_t>(last - first);
+  grain    = resolve_grain(n, pool, grain);
+  if (n <= grain || pool.size() < 2) {
+    sort(first, last, comp);
+    return;
+  }
+  vector<typename iterator_traits<RandomIt>::value_type> buffer(n);
+  parallel_merge_sort(pool, first, buffer.begin(), n, false, comp, grain);
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * Compares the serial standard algorithms against their parallel versions on
+ * a vector of random integers and checks that both produce the same result.
+ * The number of elements can be passed as the first argument.
+ *
+ * @return int Returns 0 if every parallel result matches the serial one.
+ */
+int main(int argc, char* argv[])
+{
+  size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+
+  ThreadPool pool;
+  cout << "Elements: " << n << ", workers: " << pool.size() << '\n';
+
+  mt19937_64      rng(42);
+  vector<int64_t> numbers(n);
+  for (auto& number : numbers) {
+    number = static_cast<int64_t>(rng() % 1000000);
+  }
+
+  int64_t serial_sum   = 0;
+  int64_t parallel_sum = 0;
+  cout << "\nReduce" << '\n';
+  cout << "std::accumulate: " << time_ms([&] { serial_sum = accumulate(numbers.begin(), numbers.end(), int64_t{0}); }) << " ms\n";
+  cout << "parallel_reduce: " << time_ms([&] { parallel_sum = parallel_reduce(pool, numbers.begin(), numbers.end(), int64_t{0}); }) << " ms\n";
+
+  vector<int64_t> serial_squares(n);
+  vector<int64_t> parallel_squares(n);
+  auto            square = [](int64_t x) { return x * x; };
+  cout << "\nTransform" << '\n';
+  cout << "std::transform: " << time_ms([&] { transform(numbers.begin(), numbers.end(), serial_squares.begin(), square); }) << " ms\n";
+  cout << "parallel_transform: "
+       << time_ms([&] { parallel_transform(pool, numbers.begin(), numbers.end(), parallel_squares.begin(), square); }) << " ms\n";
+
+  cout << "\nFor each" << '\n';
+  cout << "parallel_for_each: " << time_ms([&] { parallel_for_each(pool, parallel_squares.begin(), parallel_squares.end(), [](int64_t& x) { x -= 1; }); })
+       << " ms\n";
+  for_each(serial_squares.begin(), serial_squares.end(), [](int64_t& x) { x -= 1; });
+
+  vector<int64_t> serial_sorted   = numbers;
+  vector<int64_t> parallel_sorted = numbers;
+  cout << "\nSort" << '\n';
+  cout << "std::sort: " << time_ms([&] { sort(serial_sorted.begin(), serial_sorted.end()); }) << " ms\n";
+  cout << "parallel_sort: " << time_ms([&] { parallel_sort(pool, parallel_sorted.begin(), parallel_sorted.end()); }) << " ms\n";
+
+  bool ok = serial_sum == parallel_sum && serial_squares == parallel_squares && serial_sorted == parallel_sorted;
+  cout << '\n' << (ok ? "Parallel results match the serial ones" : "Parallel results DIFFER from the serial ones") << '\n';
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file perfect_hash.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Lookup tables for fixed key sets, built at compile time.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * The people of the "Predefine" option of maps.cpp and the messages of the
+ * error codes of exceptions/basic_exceptions.cpp are known at compile time.
+ * This program keeps them in constexpr StaticMaps (see static_map.h). Their
+ * perfect hash is built by the compiler, so a lookup costs one hash and one
+ * comparison, and the tables cost nothing at startup.
+ *
+ * The benchmark looks up words in a table of C++ keywords, about half of them
+ * missing. It compares StaticMap with unordered_map and map, including the
+ * time needed to build those two at run time.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "static_map.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief A person of the "Predefine" option of maps.cpp, with the name as key.
+ */
+struct PredefinedPerson
+{
+  int         id;
+  int         age;
+  string_view address;
+};
+
+constexpr auto predefined_people = make_static_map<string_view, PredefinedPerson>({
+  {"Alice", {1, 25, "123 Main St"}},
+  {"Bob", {2, 30, "456 Elm St"}},
+  {"Charlie", {3, 35, "789 Oak St"}},
+});
+
+static_assert(predefined_people.at("Bob").age == 30, "The table is built at compile time");
+static_assert(!predefined_people.contains("Dave"), "Missing names are not found");
+
+/**
+ * @brief Enumerated type for error codes, as in basic_exceptions.cpp.
+ */
+enum errorCode { ERROR_0, ERROR_1, ERROR_2 };
+
+constexpr auto error_messages = make_static_map<errorCode, string_view>({
+  {ERROR_0, "Error number 0"},
+  {ERROR_1, "Error number 1"},
+  {ERROR_2, "Error number 2"},
+});
+
+/**
+ * @brief Returns the message of an error code, like getErrorMessage() of
+ * basic_exceptions.cpp.
+ */
+constexpr string_view error_message(errorCode code)
+{
+  const string_view* message = error_messages.find(code);
+  return message != nullptr ? *message : "Unknown error";
+}
+
+static_assert(error_message(ERROR_2) == "Error number 2", "Error messages are found at compile time");
+
+/**
+ * @brief Looks up the predefined people and the error messages.
+ */
+void basic_static_map()
+{
+  for (string_view name : {"Alice", "Bob", "Charlie", "Dave"}) {
+    const PredefinedPerson* person = predefined_people.find(name);
+    if (person != nullptr) {
+      cout << "Name: " << name << " ID(" << person->id << ") -> Age: " << person->age << ", Address: " << person->address << '\n';
+    }
+    else {
+      cout << "Name: " << name << " -> Key not found" << '\n';
+    }
+  }
+  for (int code = 0; code <= 3; ++code) {
+    cout << "Error code " << code << ": " << error_message(static_cast<errorCode>(code)) << '\n';
+  }
+  cout << "Table of " << predefined_people.size() << " people: " << sizeof(predefined_people) << " bytes, " << decltype(predefined_people)::table_size
+       << " slots" << '\n';
+}
+
+constexpr auto keywords = make_static_map<string_view, int>({
+  {"alignas", 0},           {"alignof", 1},           {"asm", 2},               {"auto", 3},              {"bool", 4},
+  {"break", 5},             {"case", 6},              {"catch", 7},             {"char", 8},              {"class", 9},
+  {"const", 10},            {"constexpr", 11},        {"const_cast", 12},       {"continue", 13},         {"decltype", 14},
+  {"default", 15},          {"delete", 16},           {"do", 17},               {"double", 18},           {"dynamic_cast", 19},
+  {"else", 20},             {"enum", 21},             {"explicit", 22},         {"export", 23},           {"extern", 24},
+  {"false", 25},            {"float", 26},            {"for", 27},              {"friend", 28},           {"goto", 29},
+  {"if", 30},               {"inline", 31},           {"int", 32},              {"long", 33},             {"mutable", 34},
+  {"namespace", 35},        {"new", 36},              {"noexcept", 37},         {"nullptr", 38},          {"operator", 39},
+  {"private", 40},          {"protected", 41},        {"public", 42},           {"register", 43},         {"reinterpret_cast", 44},
+  {"return", 45},           {"short", 46},            {"signed", 47},           {"sizeof", 48},           {"static", 49},
+  {"static_assert", 50},    {"static_cast", 51},      {"struct", 52},           {"switch", 53},           {"template", 54},
+  {"this", 55},             {"thread_local", 56},     {"throw", 57},            {"true", 58},             {"try", 59},
+  {"typedef", 60},          {"typeid", 61},           {"typename", 62},         {"union", 63},            {"unsigned", 64},
+  {"using", 65},            {"virtual", 66},          {"void", 67},             {"volatile", 68},         {"while", 69}
+});
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Looks up ops words, half of them keywords, in a StaticMap, an
+ * unordered_map and a map.
+ *
+ * @param ops Number of lookups.
+ * @return bool True if the three tables gave the same results.
+ */
+bool benchmark(size_t ops)
+{
+  vector<string> words;
+  for (const auto& entry : keywords) {
+    words.emplace_back(entry.key);
+    words.push_back(string(entry.key) + "_"); // Not a keyword, with the same length and prefix
+  }
+  mt19937             rng(42);
+  vector<string_view> queries(ops);
+  for (auto& query : queries) {
+    query = words[rng() % words.size()];
+  }
+
+  unordered_map<string_view, int> hashed;
+  map<string_view, int>           ordered;
+
+  double build_hashed = time_ms([&] {
+    for (const auto& entry : keywords) {
+      hashed.emplace(entry.key, entry.value);
+    }
+  });
+  double build_ordered = time_ms([&] {
+    for (const auto& entry : keywords) {
+      ordered.emplace(entry.key, entry.value);
+    }
+  });
+
+  long long static_sum = 0, hashed_sum = 0, ordered_sum = 0;
+  cout << "\nBenchmark with " << ops << " lookups in " << keywords.size() << " keywords" << '\n';
+  cout << "StaticMap: built at compile time, lookups " << time_ms([&] {
+    for (string_view query : queries) {
+      const int* value = keywords.find(query);
+      static_sum += value != nullptr ? *value : -1;
+    }
+  }) << " ms\n";
+  cout << "unordered_map: built in " << build_hashed << " ms, lookups " << time_ms([&] {
+    for (string_view query : queries) {
+      auto it = hashed.find(query);
+      hashed_sum += it != hashed.end() ? it->second : -1;
+    }
+  }) << " ms\n";
+  cout << "map: built in " << build_ordered << " ms, lookups " << time_ms([&] {
+    for (string_view query : queries) {
+      auto it = ordered.find(query);
+      ordered_sum += it != ordered.end() ? it->second : -1;
+    }
+  }) << " ms\n";
+
+  return static_sum == hashed_sum && static_sum == ordered_sum;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of lookups of the benchmark can be passed as the first argument.
+ *
+ * @return int Returns 0 if the three tables gave the same results.
+ */
+int main(int argc, char* argv[])
+{
+  basic_static_map();
+
+  size_t ops = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+  bool   ok  = benchmark(ops);
+  cout << "Same results: " << (ok ? "yes" : "no") << '\n';
+
+  return ok ? 0 : 1;
+}
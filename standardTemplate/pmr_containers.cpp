@@ -0,0 +1,646 @@
+/**
+ * @file pmr_containers.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Polymorphic memory resources for the vector, list and map examples.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * The containers of std::pmr take a std::pmr::memory_resource instead of the
+ * global allocator. This program defines two resources:
+ * - ArenaResource: monotonic bump allocator. Deallocation is a no-op and all
+ *   the memory of a request is given back at once with reset() or release().
+ * - PoolResource: size-class pools with free lists, for containers that
+ *   allocate and free many small nodes (list and map).
+ * Both keep statistics, and both can sit on top of each other (for example a
+ * pool whose slabs come from a per-request arena).
+ *
+ * The map stores PmrKey and PmrValue, versions of CustomKey and CustomValue
+ * with pmr::string members. The map passes its resource to them, so names and
+ * addresses too long for the small string buffer come from the same resource
+ * as the nodes instead of the global heap.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "custom_types.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Counters kept by the memory resources of this file.
+ */
+struct ResourceStats
+{
+  size_t allocations          = 0; // Calls to allocate()
+  size_t deallocations        = 0; // Calls to deallocate()
+  size_t bytes_in_use         = 0; // Bytes allocated and not yet deallocated
+  size_t peak_bytes_in_use    = 0; // Maximum of bytes_in_use
+  size_t upstream_allocations = 0; // Blocks requested from the upstream resource
+  size_t upstream_bytes       = 0; // Bytes currently held from the upstream resource
+};
+
+/**
+ * @brief Prints the counters of a resource on a single line.
+ */
+void print_stats(const string& name, const ResourceStats& stats)
+{
+  cout << name << ": allocations " << stats.allocations << ", deallocations " << stats.deallocations << ", in use " << stats.bytes_in_use
+       << " B, peak " << stats.peak_bytes_in_use << " B, upstream blocks " << stats.upstream_allocations << ", upstream held "
+       << stats.upstream_bytes << " B\n";
+}
+
+/**
+ * @brief Monotonic arena: hands out memory by bumping a pointer inside large
+ * chunks obtained from an upstream resource.
+ *
+ * deallocate() does not reclaim anything. reset() rewinds the arena in O(1)
+ * while keeping its largest chunk for the next request, and release() gives
+ * every chunk back to the upstream resource. Not thread safe.
+ */
+class ArenaResource : public pmr::memory_resource
+{
+public:
+  /**
+   * @param initial_chunk Size of the first chunk. Later chunks double in size.
+   * @param upstream      Resource the chunks are obtained from.
+   */
+  explicit ArenaResource(size_t initial_chunk = 64 * 1024, pmr::memory_resource* upstream = pmr::new_delete_resource())
+    : upstream_(upstream), initial_chunk_(initial_chunk), next_chunk_(initial_chunk)
+  {
+  }
+
+  ArenaResource(const ArenaResource&)            = delete;
+  ArenaResource& operator=(const ArenaResource&) = delete;
+
+  ~ArenaResource() override
+  {
+    release();
+  }
+
+  /**
+   * @brief Frees every allocation at once, keeping the most recent (largest)
+   * chunk so the next request does not have to go upstream.
+   */
+  void reset()
+  {
+    if (chunks_ == nullptr) {
+      return;
+    }
+    free_chunks(chunks_->next);
+    chunks_->next       = nullptr;
+    cursor_             = reinterpret_cast<char*>(chunks_) + sizeof(Chunk);
+    end_                = reinterpret_cast<char*>(chunks_) + chunks_->size;
+    stats_.bytes_in_use = 0;
+  }
+
+  /**
+   * @brief Gives every chunk back to the upstream resource.
+   */
+  void release()
+  {
+    free_chunks(chunks_);
+    chunks_             = nullptr;
+    cursor_             = nullptr;
+    end_                = nullptr;
+    next_chunk_         = initial_chunk_;
+    stats_.bytes_in_use = 0;
+  }
+
+  const ResourceStats& stats() const
+  {
+    return stats_;
+  }
+
+protected:
+  void* do_allocate(size_t bytes, size_t alignment) override
+  {
+    void*  p     = cursor_;
+    size_t space = static_cast<size_t>(end_ - cursor_);
+    if (cursor_ == nullptr || align(alignment, bytes, p, space) == nullptr) {
+      add_chunk(bytes + alignment);
+      p     = cursor_;
+      space = static_cast<size_t>(end_ - cursor_);
+      align(alignment, bytes, p, space);
+    }
+    cursor_ = static_cast<char*>(p) + bytes;
+
+    ++stats_.allocations;
+    stats_.bytes_in_use += bytes;
+    stats_.peak_bytes_in_use = max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+    return p;
+  }
+
+  void do_deallocate(void*, size_t bytes, size_t) override
+  {
+    ++stats_.deallocations;
+    stats_.bytes_in_use -= min(bytes, stats_.bytes_in_use);
+  }
+
+  bool do_is_equal(const pmr::memory_resource& other) const noexcept override
+  {
+    return this == &other;
+  }
+
+private:
+  /**
+   * @brief Header stored at the start of every chunk.
+   */
+  struct alignas(max_align_t) Chunk
+  {
+    Chunk* next;
+    size_t size;
+  };
+
+  void add_chunk(size_t min_bytes)
+  {
+    size_t size  = max(next_chunk_, min_bytes + sizeof(Chunk));
+    auto*  chunk = static_cast<Chunk*>(upstream_->allocate(size, alignof(Chunk)));
+    chunk->next  = chunks_;
+    chunk->size  = size;
+    chunks_      = chunk;
+    cursor_      = reinterpret_cast<char*>(chunk) + sizeof(Chunk);
+    end_         = reinterpret_cast<char*>(chunk) + size;
+    next_chunk_  = size * 2;
+
+    ++stats_.upstream_allocations;
+    stats_.upstream_bytes += size;
+  }
+
+  void free_chunks(Chunk* chunk)
+  {
+    while (chunk != nullptr) {
+      Chunk* next = chunk->next;
+      stats_.upstream_bytes -= chunk->size;
+      upstream_->deallocate(chunk, chunk->size, alignof(Chunk));
+      chunk = next;
+    }
+  }
+
+  pmr::memory_resource* upstream_;
+  size_t                initial_chunk_;
+  size_t                next_chunk_;
+  Chunk*                chunks_ = nullptr;
+  char*                 cursor_ = nullptr;
+  char*                 end_    = nullptr;
+  ResourceStats         stats_;
+};
+
+/**
+ * @brief Pool resource with one free list per size class.
+ *
+ * Requests of up to 512 bytes are rounded up to a power of two and served
+ * from slabs of equally sized blocks; freed blocks go back to their free list.
+ * Larger or over-aligned requests are forwarded to the upstream resource. Not
+ * thread safe.
+ */
+class PoolResource : public pmr::memory_resource
+{
+public:
+  static constexpr size_t num_classes   = 7; // 8, 16, 32, 64, 128, 256 and 512 bytes
+  static constexpr size_t max_pooled    = 512;
+  static constexpr size_t slab_capacity = 16 * 1024;
+
+  explicit PoolResource(pmr::memory_resource* upstream = pmr::new_delete_resource()) : upstream_(upstream)
+  {
+  }
+
+  PoolResource(const PoolResource&)            = delete;
+  PoolResource& operator=(const PoolResource&) = delete;
+
+  ~PoolResource() override
+  {
+    release();
+  }
+
+  /**
+   * @brief Gives every slab back to the upstream resource. Blocks still in use
+   * become invalid.
+   */
+  void release()
+  {
+    for (const auto& slab : slabs_) {
+      upstream_->deallocate(slab.first, slab.second, alignof(max_align_t));
+      stats_.upstream_bytes -= slab.second;
+    }
+    slabs_.clear();
+    free_lists_.fill(nullptr);
+    stats_.bytes_in_use = 0;
+  }
+
+  const ResourceStats& stats() const
+  {
+    return stats_;
+  }
+
+  /**
+   * @brief Returns how many allocations each size class has served.
+   */
+  const array<size_t, num_classes>& class_allocations() const
+  {
+    return class_allocations_;
+  }
+
+protected:
+  void* do_allocate(size_t bytes, size_t alignment) override
+  {
+    ++stats_.allocations;
+    stats_.bytes_in_use += bytes;
+    stats_.peak_bytes_in_use = max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+
+    if (bytes > max_pooled || alignment > alignof(max_align_t)) {
+      ++stats_.upstream_allocations;
+      stats_.upstream_bytes += bytes;
+      return upstream_->allocate(bytes, alignment);
+    }
+    // A block of a class is aligned to its size (up to the alignment of the
+    // slab), so a class at least as large as the alignment is enough
+    size_t index = size_class(max(bytes, alignment));
+    ++class_allocations_[index];
+    if (free_lists_[index] == nullptr) {
+      refill(index);
+    }
+    FreeBlock* block   = free_lists_[index];
+    free_lists_[index] = block->next;
+    return block;
+  }
+
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override
+  {
+    ++stats_.deallocations;
+    stats_.bytes_in_use -= bytes;
+
+    if (bytes > max_pooled || alignment > alignof(max_align_t)) {
+      upstream_->deallocate(p, bytes, alignment);
+      stats_.upstream_bytes -= bytes;
+      return;
+    }
+    size_t index       = size_class(max(bytes, alignment));
+    auto*  block       = static_cast<FreeBlock*>(p);
+    block->next        = free_lists_[index];
+    free_lists_[index] = block;
+  }
+
+  bool do_is_equal(const pmr::memory_resource& other) const noexcept override
+  {
+    return this == &other;
+  }
+
+private:
+  struct FreeBlock
+  {
+    FreeBlock* next;
+  };
+
+  static size_t size_class(size_t bytes)
+  {
+    size_t index = 0;
+    for (size_t size = 8; size < bytes; size *= 2) {
+      ++index;
+    }
+    return index;
+  }
+
+  static size_t class_size(size_t index)
+  {
+    return size_t{8} << index;
+  }
+
+  /**
+   * @brief Carves a new slab into blocks of the given class and pushes them
+   * onto its free list.
+   */
+  void refill(size_t index)
+  {
+    size_t block = class_size(index);
+    size_t count = max<size_t>(slab_capacity / block, 32);
+    size_t bytes = block * count;
+    char*  slab  = static_cast<char*>(upstream_->allocate(bytes, alignof(max_align_t)));
+    slabs_.emplace_back(slab, bytes);
+    ++stats_.upstream_allocations;
+    stats_.upstream_bytes += bytes;
+
+    for (size_t i = count; i-- > 0;) {
+      auto* free_block   = reinterpret_cast<FreeBlock*>(slab + i * block);
+      free_block->next   = free_lists_[index];
+      free_lists_[index] = free_block;
+    }
+  }
+
+  pmr::memory_resource*          upstream_;
+  array<FreeBlock*, num_classes> free_lists_{};
+  array<size_t, num_classes>     class_allocations_{};
+  vector<pair<void*, size_t>>    slabs_;
+  ResourceStats                  stats_;
+};
+
+/**
+ * @brief CustomKey with a pmr::string name.
+ *
+ * It declares allocator_type and takes the allocator as last constructor
+ * argument, so pmr containers construct it with their own resource.
+ */
+class PmrKey
+{
+public:
+  using allocator_type = pmr::polymorphic_allocator<char>;
+
+  int         id;
+  pmr::string name;
+
+  PmrKey(int key_id, string_view key_name, const allocator_type& alloc = {}) : id(key_id), name(key_name, alloc)
+  {
+  }
+
+  PmrKey(const PmrKey& other, const allocator_type& alloc = {}) : id(other.id), name(other.name, alloc)
+  {
+  }
+
+  PmrKey(PmrKey&& other) noexcept = default;
+
+  PmrKey(PmrKey&& other, const allocator_type& alloc) : id(other.id), name(move(other.name), alloc)
+  {
+  }
+
+  PmrKey& operator=(const PmrKey&) = default;
+  PmrKey& operator=(PmrKey&&)      = default;
+
+  bool operator<(const PmrKey& other) const
+  {
+    if (id == other.id) {
+      return name < other.name;
+    }
+    else {
+      return id < other.id;
+    }
+  }
+};
+
+/**
+ * @brief CustomValue with a pmr::string address.
+ */
+class PmrValue
+{
+public:
+  using allocator_type = pmr::polymorphic_allocator<char>;
+
+  int         age;
+  pmr::string address;
+
+  PmrValue(int value_age, string_view value_address, const allocator_type& alloc = {}) : age(value_age), address(value_address, alloc)
+  {
+  }
+
+  PmrValue(const PmrValue& other, const allocator_type& alloc = {}) : age(other.age), address(other.address, alloc)
+  {
+  }
+
+  PmrValue(PmrValue&& other) noexcept = default;
+
+  PmrValue(PmrValue&& other, const allocator_type& alloc) : age(other.age), address(move(other.address), alloc)
+  {
+  }
+
+  PmrValue& operator=(const PmrValue&) = default;
+  PmrValue& operator=(PmrValue&&)      = default;
+};
+
+/**
+ * @brief Typical vector work: grow by push_back, read everything, shrink.
+ */
+template <typename Vector>
+long long vector_mix(Vector& v, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    v.push_back(static_cast<int>(i));
+  }
+  long long sum = 0;
+  for (int x : v) {
+    sum += x;
+  }
+  v.resize(n / 2);
+  v.shrink_to_fit();
+  return sum;
+}
+
+/**
+ * @brief Typical list work: push at both ends, remove a value, sort.
+ */
+template <typename List>
+long long list_mix(List& l, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    if (i % 2 == 0) {
+      l.push_back(static_cast<int>(i % 1000));
+    }
+    else {
+      l.push_front(static_cast<int>(i % 1000));
+    }
+  }
+  l.remove(0);
+  l.sort();
+  return static_cast<long long>(l.size());
+}
+
+/**
+ * @brief Typical map work: insert, find by key, erase half of the entries.
+ */
+template <typename Map>
+long long map_mix(Map& m, const vector<typename Map::key_type>& keys, const string& address)
+{
+  for (const auto& key : keys) {
+    // Piecewise, so the value is built in the node with the map's allocator
+    m.emplace(piecewise_construct, forward_as_tuple(key), forward_as_tuple(key.id % 100, address));
+  }
+  long long found = 0;
+  for (const auto& key : keys) {
+    found += static_cast<long long>(m.count(key));
+  }
+  for (size_t i = 0; i < keys.size(); i += 2) {
+    m.erase(keys[i]);
+  }
+  return found + static_cast<long long>(m.size());
+}
+
+/**
+ * @brief Runs f the given number of times and returns the elapsed time in
+ * milliseconds.
+ */
+template <typename F>
+double time_ms(size_t repetitions, F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  for (size_t i = 0; i < repetitions; ++i) {
+    f();
+  }
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Prints one benchmark row.
+ */
+void report(const string& name, double ms)
+{
+  cout << "  " << name << ": " << ms << " ms\n";
+}
+
+/**
+ * @brief Map rows of the benchmark, for names made of prefix and a number and
+ * for the given address.
+ */
+void map_benchmark(size_t requests, size_t n, const string& prefix, const string& address, PoolResource& pool, ArenaResource& arena,
+                   long long& checksum)
+{
+  vector<CustomKey> keys;
+  vector<PmrKey>    pmr_keys;
+  for (size_t i = 0; i < n; ++i) {
+    keys.emplace_back(static_cast<int>((i * 7919) % n), prefix + to_string(i % 97));
+    pmr_keys.emplace_back(keys.back().id, keys.back().name);
+  }
+
+  cout << "map<CustomKey, CustomValue>, names like \"" << prefix << "42\", addresses of " << address.size() << " chars" << '\n';
+  report("std::allocator", time_ms(requests, [&] {
+           map<CustomKey, CustomValue> m;
+           checksum += map_mix(m, keys, address);
+         }));
+  report("PoolResource", time_ms(requests, [&] {
+           pmr::map<PmrKey, PmrValue> m(&pool);
+           checksum += map_mix(m, pmr_keys, address);
+         }));
+  report("ArenaResource", time_ms(requests, [&] {
+           {
+             pmr::map<PmrKey, PmrValue> m(&arena);
+             checksum += map_mix(m, pmr_keys, address);
+           }
+           arena.reset();
+         }));
+}
+
+/**
+ * @brief Compares the default allocator, the pool resource and a per-request
+ * arena on the operation mix of each container.
+ *
+ * Each "request" builds a container, runs its mix and destroys it. With the
+ * arena the request ends with reset(), which frees everything at once. The
+ * map runs twice: with strings that fit in the small string buffer, and with
+ * strings long enough to be allocated.
+ *
+ * @param requests Number of requests.
+ * @param n        Elements per request.
+ */
+void benchmark(size_t requests, size_t n)
+{
+  PoolResource  pool;
+  ArenaResource arena;
+  long long     checksum = 0;
+
+  cout << "\nBenchmark: " << requests << " requests of " << n << " elements" << '\n';
+
+  cout << "vector<int>" << '\n';
+  report("std::allocator", time_ms(requests, [&] {
+           vector<int> v;
+           checksum += vector_mix(v, n);
+         }));
+  report("PoolResource", time_ms(requests, [&] {
+           pmr::vector<int> v(&pool);
+           checksum += vector_mix(v, n);
+         }));
+  report("ArenaResource", time_ms(requests, [&] {
+           {
+             pmr::vector<int> v(&arena);
+             checksum += vector_mix(v, n);
+           }
+           arena.reset();
+         }));
+
+  cout << "list<int>" << '\n';
+  report("std::allocator", time_ms(requests, [&] {
+           list<int> l;
+           checksum += list_mix(l, n);
+         }));
+  report("PoolResource", time_ms(requests, [&] {
+           pmr::list<int> l(&pool);
+           checksum += list_mix(l, n);
+         }));
+  report("ArenaResource", time_ms(requests, [&] {
+           {
+             pmr::list<int> l(&arena);
+             checksum += list_mix(l, n);
+           }
+           arena.reset();
+         }));
+
+  map_benchmark(requests, n, "user", "Main St", pool, arena, checksum);
+  map_benchmark(requests, n, "registered customer ", "1234 North Longfellow Avenue, Apartment 56", pool, arena, checksum);
+
+  cout << "\nChecksum: " << checksum << '\n';
+  print_stats("PoolResource", pool.stats());
+  print_stats("ArenaResource", arena.stats());
+  const auto& classes = pool.class_allocations();
+  cout << "PoolResource size classes:";
+  for (size_t i = 0; i < classes.size(); ++i) {
+    cout << ' ' << (size_t{8} << i) << "B=" << classes[i];
+  }
+  cout << '\n';
+}
+
+/**
+ * @brief Builds the "Predefine" map of maps.cpp inside a request-scoped arena
+ * and a pool stacked on top of it.
+ */
+void basic_pmr_map()
+{
+  ArenaResource request_arena(4096);
+  PoolResource  nodes(&request_arena);
+  {
+    pmr::map<PmrKey, PmrValue> myMap(&nodes);
+    myMap.emplace(piecewise_construct, forward_as_tuple(1, "Alice"), forward_as_tuple(25, "123 Main St"));
+    myMap.emplace(piecewise_construct, forward_as_tuple(2, "Bob"), forward_as_tuple(30, "456 Elm St"));
+    myMap.emplace(piecewise_construct, forward_as_tuple(3, "Charlie"), forward_as_tuple(35, "789 Oak St"));
+    myMap.erase(myMap.begin());
+
+    for (const auto& pair : myMap) {
+      cout << "Name: " << pair.first.name << " ID(" << pair.first.id << ") -> Age: " << pair.second.age << ", Address: " << pair.second.address
+           << endl;
+    }
+    print_stats("Pool", nodes.stats());
+    print_stats("Arena", request_arena.stats());
+  }
+  // End of the request: the pool returns its slabs and the arena frees them all at once
+  nodes.release();
+  request_arena.release();
+  print_stats("Arena after release", request_arena.stats());
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of requests and the elements per request can be passed as the
+ * first and second arguments.
+ *
+ * @return int Returns 0 upon successful execution.
+ */
+int main(int argc, char* argv[])
+{
+  basic_pmr_map();
+
+  size_t requests = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200;
+  size_t n        = argc > 2 ? strtoull(argv[2], nullptr, 10) : 10000;
+  benchmark(requests, n);
+
+  return 0;
+}
@@ -0,0 +1,472 @@
+/**
+ * @file radix_sort.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Radix sorts for integer keys and key-value pairs, for vectors and
+ * lists, compared with std::sort and list::sort.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * sort() in lists.cpp calls list::sort(), a comparison merge sort that
+ * follows pointers between scattered nodes. Integer keys can be sorted
+ * without comparisons: a radix sort distributes the elements into 256
+ * buckets by one byte of the key at a time, which costs a few sequential
+ * passes over the data whatever the order of the input.
+ *
+ * - lsd_radix_sort(): least significant byte first, stable, uses a buffer
+ *   the size of the input. Passes where every key has the same byte are
+ *   skipped.
+ * - msd_radix_sort(): most significant byte first, in place (American flag
+ *   sort), not stable.
+ * - parallel_radix_sort(): lsd_radix_sort() with every pass split between
+ *   threads.
+ * - radix_sort(list&): sorts the keys of the nodes in a contiguous buffer and
+ *   relinks the nodes in order, so iterators stay valid as with list::sort.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Maps an integer to an unsigned key with the same order: signed
+ * values get their sign bit flipped, so negative numbers come first.
+ */
+template <typename T>
+make_unsigned_t<T> radix_key(T value)
+{
+  static_assert(is_integral<T>::value, "radix_key needs an integral type");
+  using U = make_unsigned_t<T>;
+  U key   = static_cast<U>(value);
+  if (is_signed<T>::value) {
+    key ^= U(1) << (8 * sizeof(U) - 1);
+  }
+  return key;
+}
+
+/**
+ * @brief Key extractor for integers, the default of the sorts below.
+ */
+struct IntegerKey
+{
+  template <typename T>
+  make_unsigned_t<T> operator()(const T& value) const
+  {
+    return radix_key(value);
+  }
+};
+
+/**
+ * @brief Key extractor for pairs sorted by their integer first member.
+ */
+struct PairFirstKey
+{
+  template <typename K, typename V>
+  make_unsigned_t<K> operator()(const pair<K, V>& p) const
+  {
+    return radix_key(p.first);
+  }
+};
+
+/**
+ * @brief Stable least significant digit radix sort.
+ *
+ * @param data   The elements to sort.
+ * @param buffer Scratch space for n elements.
+ * @param n      Number of elements.
+ * @param key    Returns the unsigned integer key of an element.
+ */
+template <typename T, typename KeyFn = IntegerKey>
+void lsd_radix_sort(T* data, T* buffer, size_t n, KeyFn key = KeyFn())
+{
+  using Key = decltype(key(*data));
+  static_assert(is_unsigned<Key>::value, "the key must be an unsigned integer");
+  constexpr size_t passes = sizeof(Key);
+  if (n < 2) {
+    return;
+  }
+
+  // One read of the input builds the histograms of every byte
+  vector<size_t> counts(passes * 256, 0);
+  for (size_t i = 0; i < n; ++i) {
+    Key k = key(data[i]);
+    for (size_t p = 0; p < passes; ++p) {
+      ++counts[p * 256 + (k >> (8 * p) & 0xFF)];
+    }
+  }
+
+  T* src = data;
+  T* dst = buffer;
+  for (size_t p = 0; p < passes; ++p) {
+    size_t* count = &counts[p * 256];
+    if (count[key(src[0]) >> (8 * p) & 0xFF] == n) {
+      continue; // Every key has the same byte here
+    }
+    size_t offset = 0;
+    for (size_t d = 0; d < 256; ++d) {
+      size_t c = count[d];
+      count[d] = offset;
+      offset += c;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      dst[count[key(src[i]) >> (8 * p) & 0xFF]++] = move(src[i]);
+    }
+    swap(src, dst);
+  }
+  if (src != data) {
+    move(src, src + n, data);
+  }
+}
+
+/**
+ * @brief Sorts a vector with lsd_radix_sort().
+ */
+template <typename T, typename KeyFn = IntegerKey>
+void lsd_radix_sort(vector<T>& v, KeyFn key = KeyFn())
+{
+  vector<T> buffer(v.size());
+  lsd_radix_sort(v.data(), buffer.data(), v.size(), key);
+}
+
+/**
+ * @brief In-place most significant digit radix sort (American flag sort).
+ *
+ * Each level counts the current byte of the keys, then moves every element
+ * straight to its bucket by following cycles of swaps, and sorts each
+ * bucket by the next byte. Buckets of fewer than 64 elements are finished
+ * with an insertion sort. Not stable.
+ *
+ * @param data Elements to sort.
+ * @param n    Number of elements.
+ * @param key  Returns the unsigned integer key of an element.
+ */
+template <typename T, typename KeyFn = IntegerKey>
+void msd_radix_sort(T* data, size_t n, KeyFn key = KeyFn(), int shift = -1)
+{
+  using Key = decltype(key(*data));
+  static_assert(is_unsigned<Key>::value, "the key must be an unsigned integer");
+  if (shift < 0) {
+    shift = 8 * (static_cast<int>(sizeof(Key)) - 1);
+  }
+
+  if (n < 64) {
+    for (size_t i = 1; i < n; ++i) {
+      T      value = move(data[i]);
+      Key    k     = key(value);
+      size_t j     = i;
+      for (; j > 0 && key(data[j - 1]) > k; --j) {
+        data[j] = move(data[j - 1]);
+      }
+      data[j] = move(value);
+    }
+    return;
+  }
+
+  auto   digit      = [&](const T& value) { return static_cast<size_t>(key(value) >> shift & 0xFF); };
+  size_t count[256] = {};
+  for (size_t i = 0; i < n; ++i) {
+    ++count[digit(data[i])];
+  }
+
+  if (count[digit(data[0])] != n) {
+    size_t head[256];
+    size_t tail[256];
+    size_t offset = 0;
+    for (size_t d = 0; d < 256; ++d) {
+      head[d] = offset;
+      offset += count[d];
+      tail[d] = offset;
+    }
+    for (size_t b = 0; b < 256; ++b) {
+      while (head[b] < tail[b]) {
+        T      value = move(data[head[b]]);
+        size_t d     = digit(value);
+        while (d != b) {
+          swap(value, data[head[d]++]);
+          d = digit(value);
+        }
+        data[head[b]++] = move(value);
+      }
+    }
+  }
+
+  if (shift == 0) {
+    return;
+  }
+  for (size_t d = 0, start = 0; d < 256; start += count[d], ++d) {
+    if (count[d] > 1) {
+      msd_radix_sort(data + start, count[d], key, shift - 8);
+    }
+  }
+}
+
+/**
+ * @brief Multithreaded stable LSD radix sort.
+ *
+ * Each thread owns a contiguous chunk of the input. For every byte, the
+ * threads count their chunk, the counts are turned into one output offset
+ * per (byte value, thread), and each thread scatters its chunk. Keeping the
+ * threads in order within each bucket keeps the sort stable.
+ *
+ * @param data        Elements to sort.
+ * @param n           Number of elements.
+ * @param num_threads Number of threads. 0 uses the number of hardware threads.
+ * @param key         Returns the unsigned integer key of an element.
+ */
+template <typename T, typename KeyFn = IntegerKey>
+void parallel_radix_sort(T* data, size_t n, unsigned num_threads = 0, KeyFn key = KeyFn())
+{
+  using Key = decltype(key(*data));
+  static_assert(is_unsigned<Key>::value, "the key must be an unsigned integer");
+  if (num_threads == 0) {
+    num_threads = max(1u, thread::hardware_concurrency());
+  }
+  // Below about 64K elements per thread, starting the threads costs more than it saves
+  num_threads = static_cast<unsigned>(max<size_t>(1, min<size_t>(num_threads, n / 65536)));
+  if (num_threads == 1) {
+    vector<T> buffer(n);
+    lsd_radix_sort(data, buffer.data(), n, key);
+    return;
+  }
+
+  vector<T>      buffer(n);
+  vector<size_t> counts(num_threads * 256);
+  T*             src = data;
+  T*             dst = buffer.data();
+
+  auto run = [num_threads](auto task) {
+    vector<thread> threads;
+    for (unsigned t = 1; t < num_threads; ++t) {
+      threads.emplace_back(task, t);
+    }
+    task(0u);
+    for (auto& th : threads) {
+      th.join();
+    }
+  };
+  auto chunk_begin = [n, num_threads](unsigned t) { return n / num_threads * t; };
+  auto chunk_end   = [n, num_threads](unsigned t) { return t + 1 == num_threads ? n : n / num_threads * (t + 1); };
+
+  for (size_t p = 0; p < sizeof(Key); ++p) {
+    int shift = static_cast<int>(8 * p);
+    run([&](unsigned t) {
+      size_t* count = &counts[t * 256];
+      fill(count, count + 256, 0);
+      for (size_t i = chunk_begin(t); i < chunk_end(t); ++i) {
+        ++count[key(src[i]) >> shift & 0xFF];
+      }
+    });
+
+    size_t offset = 0;
+    bool   skip   = false;
+    for (size_t d = 0; d < 256; ++d) {
+      size_t bucket = 0;
+      for (unsigned t = 0; t < num_threads; ++t) {
+        bucket += counts[t * 256 + d];
+      }
+      skip = skip || bucket == n;
+      for (unsigned t = 0; t < num_threads; ++t) {
+        size_t c            = counts[t * 256 + d];
+        counts[t * 256 + d] = offset;
+        offset += c;
+      }
+    }
+    if (skip) {
+      continue; // Every key has the same byte here
+    }
+
+    run([&](unsigned t) {
+      size_t* next = &counts[t * 256];
+      for (size_t i = chunk_begin(t); i < chunk_end(t); ++i) {
+        dst[next[key(src[i]) >> shift & 0xFF]++] = move(src[i]);
+      }
+    });
+    swap(src, dst);
+  }
+  if (src != data) {
+    move(src, src + n, data);
+  }
+}
+
+/**
+ * @brief Sorts a list by an integer key with a radix sort.
+ *
+ * The keys are copied to a contiguous buffer together with an iterator to
+ * their node, sorted there, and the nodes are spliced to the end of the list
+ * in sorted order. No element is copied or moved, so iterators and
+ * references stay valid, as with list::sort(). The sort is stable.
+ */
+template <typename T, typename KeyFn = IntegerKey>
+void radix_sort(list<T>& l, KeyFn key = KeyFn())
+{
+  using Key = decltype(key(l.front()));
+  vector<pair<Key, typename list<T>::iterator>> refs;
+  refs.reserve(l.size());
+  for (auto it = l.begin(); it != l.end(); ++it) {
+    refs.emplace_back(key(*it), it);
+  }
+  vector<pair<Key, typename list<T>::iterator>> buffer(refs.size());
+  lsd_radix_sort(refs.data(), buffer.data(), refs.size(), [](const auto& r) { return r.first; });
+  for (const auto& r : refs) {
+    l.splice(l.end(), l, r.second);
+  }
+}
+
+/**
+ * @brief Prints the elements of a list, in the same format as print_list()
+ * in lists.cpp.
+ */
+void print_list(const list<int>& l)
+{
+  cout << "Lista: ";
+  for (const auto& elem : l) {
+    cout << elem << ' ';
+  }
+  cout << '\n';
+}
+
+/**
+ * @brief Sorts a small list, a vector of negative and positive numbers and
+ * a vector of key-value pairs.
+ */
+void basic_radix_sort()
+{
+  list<int> l = {5, 3, 8, 1, -4, 7, 3};
+  print_list(l);
+  radix_sort(l);
+  print_list(l);
+
+  vector<long long> v = {40, -1, 1LL << 40, -(1LL << 40), 0, 7};
+  msd_radix_sort(v.data(), v.size());
+  for (auto x : v) {
+    cout << x << ' ';
+  }
+  cout << '\n';
+
+  vector<pair<unsigned, string>> people = {{30, "Ana"}, {25, "Luis"}, {30, "Marta"}, {19, "Pablo"}};
+  lsd_radix_sort(people, PairFirstKey());
+  for (const auto& p : people) {
+    cout << p.first << ": " << p.second << '\n';
+  }
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Sorts the same data with std::sort and every radix sort.
+ *
+ * @param name Name of the distribution.
+ * @param data Input data.
+ * @return bool True if every sort gives the std::sort result.
+ */
+template <typename T>
+bool benchmark(const string& name, const vector<T>& data)
+{
+  cout << name << ", " << data.size() << " elements" << '\n';
+  vector<T> expected = data;
+  cout << "  std::sort:           " << time_ms([&] { sort(expected.begin(), expected.end()); }) << " ms\n";
+
+  vector<T> lsd = data;
+  cout << "  lsd_radix_sort:      " << time_ms([&] { lsd_radix_sort(lsd); }) << " ms\n";
+
+  vector<T> msd = data;
+  cout << "  msd_radix_sort:      " << time_ms([&] { msd_radix_sort(msd.data(), msd.size()); }) << " ms\n";
+
+  vector<T> parallel = data;
+  cout << "  parallel_radix_sort: " << time_ms([&] { parallel_radix_sort(parallel.data(), parallel.size()); }) << " ms\n";
+
+  return lsd == expected && msd == expected && parallel == expected;
+}
+
+/**
+ * @brief Compares list::sort() with radix_sort() on a list.
+ */
+bool benchmark_list(const vector<int>& data)
+{
+  cout << "list<int>, " << data.size() << " elements" << '\n';
+  list<int> expected(data.begin(), data.end());
+  cout << "  list::sort:          " << time_ms([&] { expected.sort(); }) << " ms\n";
+  list<int> sorted(data.begin(), data.end());
+  cout << "  radix_sort:          " << time_ms([&] { radix_sort(sorted); }) << " ms\n";
+  return sorted == expected;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of elements of the benchmark can be passed as the first
+ * argument.
+ *
+ * @return int Returns 0 if every sort gives the same results as std::sort.
+ */
+int main(int argc, char* argv[])
+{
+  basic_radix_sort();
+
+  size_t     n = argc > 1 ? strtoull(argv[1], nullptr, 10) : 10000000;
+  mt19937_64 rng(38);
+  bool       ok = true;
+  cout << '\n';
+
+  vector<int> uniform(n);
+  for (auto& x : uniform) {
+    x = static_cast<int>(rng());
+  }
+  ok = benchmark("int32, uniform", uniform) && ok;
+
+  vector<int> small(n);
+  for (auto& x : small) {
+    x = static_cast<int>(rng() % 256);
+  }
+  ok = benchmark("int32, 256 distinct values", small) && ok;
+
+  vector<int> nearly_sorted(n);
+  for (size_t i = 0; i < n; ++i) {
+    nearly_sorted[i] = static_cast<int>(i) + static_cast<int>(rng() % 16);
+  }
+  ok = benchmark("int32, nearly sorted", nearly_sorted) && ok;
+
+  vector<uint64_t> wide(n);
+  for (auto& x : wide) {
+    x = rng();
+  }
+  ok = benchmark("uint64, uniform", wide) && ok;
+
+  vector<pair<uint32_t, uint32_t>> pairs(n);
+  for (size_t i = 0; i < n; ++i) {
+    pairs[i] = {static_cast<uint32_t>(rng() % 1000), static_cast<uint32_t>(i)};
+  }
+  vector<pair<uint32_t, uint32_t>> expected_pairs = pairs;
+  cout << "key-value pairs, " << n << " elements" << '\n';
+  cout << "  std::stable_sort:    " << time_ms([&] {
+    stable_sort(expected_pairs.begin(), expected_pairs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  }) << " ms\n";
+  cout << "  lsd_radix_sort:      " << time_ms([&] { lsd_radix_sort(pairs, PairFirstKey()); }) << " ms\n";
+  ok = pairs == expected_pairs && ok;
+
+  ok = benchmark_list(vector<int>(uniform.begin(), uniform.begin() + static_cast<ptrdiff_t>(min<size_t>(n, 2000000)))) && ok;
+
+  cout << "Same results as std::sort: " << (ok ? "yes" : "no") << '\n';
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file range_formatter.h
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Buffered formatter for containers, used by the print functions of
+ * the vector, list and map examples.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Streaming a container element by element into cout goes through the
+ * iostream machinery once per element. RangeFormatter converts numbers with
+ * std::to_chars into a reusable buffer and writes it to the stream in large
+ * chunks, so dumping a big container costs little more than the I/O itself.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef RANGE_FORMATTER_H
+#define RANGE_FORMATTER_H
+
+#include <charconv>
+#include <iostream>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief True for types that can be iterated with begin() and end().
+ */
+template <typename T, typename = void>
+struct is_range : std::false_type
+{
+};
+
+template <typename T>
+struct is_range<T, std::void_t<decltype(std::begin(std::declval<const T&>())), decltype(std::end(std::declval<const T&>()))>> : std::true_type
+{
+};
+
+/**
+ * @brief True for std::pair.
+ */
+template <typename T>
+struct is_pair : std::false_type
+{
+};
+
+template <typename A, typename B>
+struct is_pair<std::pair<A, B>> : std::true_type
+{
+};
+
+/**
+ * @brief True for types written as text rather than as a range of characters.
+ */
+template <typename T>
+struct is_string_like : std::is_convertible<const T&, std::string_view>
+{
+};
+
+/**
+ * @brief Formats values and ranges into an internal buffer and writes the
+ * buffer to an output stream when it fills up, on flush() and on destruction.
+ *
+ * How write() formats a value:
+ * - Numbers with std::to_chars, chars and strings as text.
+ * - A pair as "first: second".
+ * - A range as its elements one after another. Numbers and strings are
+ *   followed by a space; pairs and nested ranges by a new line.
+ *
+ * write_range() takes a custom element formatter instead.
+ */
+class RangeFormatter
+{
+public:
+  /**
+   * @param out         Stream the buffer is written to.
+   * @param buffer_size Bytes collected before writing to the stream.
+   */
+  explicit RangeFormatter(std::ostream& out = std::cout, size_t buffer_size = 64 * 1024) : out_(out)
+  {
+    buffer_.reserve(buffer_size);
+  }
+
+  RangeFormatter(const RangeFormatter&)            = delete;
+  RangeFormatter& operator=(const RangeFormatter&) = delete;
+
+  ~RangeFormatter()
+  {
+    flush();
+  }
+
+  /**
+   * @brief Hands the buffered text to the stream. The stream keeps its own
+   * buffering, so output stays in order with other writes to it.
+   */
+  void flush()
+  {
+    write_buffer();
+  }
+
+  RangeFormatter& put(char c)
+  {
+    if (buffer_.size() == buffer_.capacity()) {
+      write_buffer();
+    }
+    buffer_.push_back(c);
+    return *this;
+  }
+
+  RangeFormatter& write(std::string_view text)
+  {
+    if (text.size() > buffer_.capacity() - buffer_.size()) {
+      write_buffer();
+      if (text.size() > buffer_.capacity()) {
+        out_.write(text.data(), static_cast<std::streamsize>(text.size()));
+        return *this;
+      }
+    }
+    buffer_.insert(buffer_.end(), text.begin(), text.end());
+    return *this;
+  }
+
+  RangeFormatter& write(const char* text)
+  {
+    return write(std::string_view(text));
+  }
+
+  RangeFormatter& write(char c)
+  {
+    return put(c);
+  }
+
+  /**
+   * @brief Formats a number, a string, a pair or a range. See the class
+   * description for the format of each kind.
+   */
+  template <typename T>
+  RangeFormatter& write(const T& value)
+  {
+    if constexpr (std::is_same<T, bool>::value) {
+      put(value ? '1' : '0');
+    }
+    else if constexpr (std::is_arithmetic<T>::value) {
+      write_number(value);
+    }
+    else if constexpr (is_string_like<T>::value) {
+      write(std::string_view(value));
+    }
+    else if constexpr (is_pair<T>::value) {
+      write(value.first).write(": ").write(value.second);
+    }
+    else {
+      static_assert(is_range<T>::value, "RangeFormatter can not format this type");
+      using Element             = std::decay_t<decltype(*std::begin(value))>;
+      constexpr bool one_a_line = (is_range<Element>::value && !is_string_like<Element>::value) || is_pair<Element>::value;
+      for (const auto& element : value) {
+        write(element);
+        put(one_a_line ? '\n' : ' ');
+      }
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Writes every element of a range with a custom formatter, each one
+   * followed by a separator.
+   *
+   * @param range     The range to write.
+   * @param format    Called as format(formatter, element) for each element.
+   * @param separator Text written after each element.
+   */
+  template <typename Range, typename ElementFormatter>
+  RangeFormatter& write_range(const Range& range, ElementFormatter format, std::string_view separator = " ")
+  {
+    for (const auto& element : range) {
+      format(*this, element);
+      write(separator);
+    }
+    return *this;
+  }
+
+private:
+  template <typename T>
+  void write_number(T value)
+  {
+    // Enough for any integer and for the shortest round-trip form of a double
+    constexpr size_t max_chars = 32;
+    if (buffer_.capacity() - buffer_.size() < max_chars) {
+      write_buffer();
+    }
+    size_t old_size = buffer_.size();
+    buffer_.resize(old_size + max_chars);
+    auto result = std::to_chars(buffer_.data() + old_size, buffer_.data() + buffer_.size(), value);
+    buffer_.resize(static_cast<size_t>(result.ptr - buffer_.data()));
+  }
+
+  void write_buffer()
+  {
+    out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    buffer_.clear();
+  }
+
+  std::ostream&     out_;
+  std::vector<char> buffer_;
+};
+
+/**
+ * @brief Returns a formatter bound to std::cout whose buffer is shared by all
+ * the print functions of a program.
+ */
+inline RangeFormatter& console_formatter()
+{
+  static RangeFormatter formatter(std::cout);
+  return formatter;
+}
+
+#endif // RANGE_FORMATTER_H
@@ -0,0 +1,583 @@
+/**
+ * @file sharded_map.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Map of CustomKey to CustomValue shared by many threads, split into
+ * shards with a reader-writer lock each.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * The map of maps.cpp is used by one thread. Sharing a std::map between
+ * threads with one mutex around it makes every thread wait for every other
+ * one, readers included. ShardedMap hashes each key to one of N shards, and
+ * each shard is a std::map with its own shared_mutex:
+ *
+ *   - readers of a shard share its lock, so they do not wait for each other;
+ *   - a writer only locks its key's shard, so writers to different shards do
+ *     not wait for each other either.
+ *
+ * A seqlock would make reads cheaper still, but it lets a reader see a value
+ * while it is being written and retry afterwards. That only works for
+ * trivially copyable values, and CustomValue holds a string.
+ *
+ * The batch operations sort their keys by shard and lock all the shards they
+ * touch, each one once, so a batch is applied or seen as a whole. snapshot()
+ * returns an immutable copy of the whole map that can be read
+ * without locks. It copies only the shards written since the last snapshot.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "custom_types.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Ordered map split into shards, each one with a reader-writer lock.
+ *
+ * Every operation on one key locks one shard. The batch operations and
+ * snapshot() lock several shards, always in increasing order, so two of them
+ * cannot wait for each other.
+ *
+ * @tparam Key     Key type.
+ * @tparam Value   Mapped type, returned by copy from the lookups.
+ * @tparam Hash    Hash of the keys, used to choose the shard.
+ * @tparam Compare Order of the keys within a shard.
+ */
+template <typename Key, typename Value, typename Hash = hash<Key>, typename Compare = less<Key>>
+class ShardedMap
+{
+public:
+  using map_type = map<Key, Value, Compare>;
+
+  /**
+   * @brief Immutable copy of a ShardedMap, read without locks.
+   *
+   * Copies of a Snapshot share the same data, and the data stays alive as
+   * long as one copy does.
+   */
+  class Snapshot
+  {
+  public:
+    const Value* find(const Key& key) const
+    {
+      const map_type& shard = *shards_[shard_index(hash_, mask_, key)];
+      auto            it    = shard.find(key);
+      return it == shard.end() ? nullptr : &it->second;
+    }
+
+    size_t size() const
+    {
+      size_t total = 0;
+      for (const auto& shard : shards_) {
+        total += shard->size();
+      }
+      return total;
+    }
+
+    /**
+     * @brief Calls f(key, value) for every entry. The entries come shard by
+     * shard, in key order within each shard.
+     */
+    template <typename F>
+    void for_each(F f) const
+    {
+      for (const auto& shard : shards_) {
+        for (const auto& [key, value] : *shard) {
+          f(key, value);
+        }
+      }
+    }
+
+  private:
+    friend class ShardedMap;
+
+    Snapshot(Hash hash, size_t mask) : hash_(hash), mask_(mask)
+    {
+    }
+
+    Hash                               hash_;
+    size_t                             mask_;
+    vector<shared_ptr<const map_type>> shards_;
+  };
+
+  /**
+   * @param shards Number of shards, rounded up to a power of two. The
+   * default is four per hardware thread, so that two threads rarely want the
+   * same shard.
+   */
+  explicit ShardedMap(size_t shards = 4 * max(1u, thread::hardware_concurrency()))
+  {
+    size_t count = 1;
+    while (count < shards) {
+      count *= 2;
+    }
+    mask_   = count - 1;
+    shards_ = make_unique<Shard[]>(count);
+  }
+
+  size_t shard_count() const
+  {
+    return mask_ + 1;
+  }
+
+  /**
+   * @brief Returns a copy of the value of key, if it is in the map.
+   */
+  optional<Value> find(const Key& key) const
+  {
+    const Shard&              shard = shard_of(key);
+    shared_lock<shared_mutex> lock(shard.entries_mutex);
+    auto                      it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+      return nullopt;
+    }
+    return it->second;
+  }
+
+  /**
+   * @brief Calls f with the value of key while holding the shard's read
+   * lock, without copying the value.
+   *
+   * @return bool True if key was found.
+   */
+  template <typename F>
+  bool visit(const Key& key, F f) const
+  {
+    const Shard&              shard = shard_of(key);
+    shared_lock<shared_mutex> lock(shard.entries_mutex);
+    auto                      it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+      return false;
+    }
+    f(it->second);
+    return true;
+  }
+
+  bool contains(const Key& key) const
+  {
+    return visit(key, [](const Value&) {});
+  }
+
+  /**
+   * @return bool True if key was inserted, false if its value was replaced.
+   */
+  bool insert_or_assign(Key key, Value value)
+  {
+    Shard&                   shard = shard_of(key);
+    lock_guard<shared_mutex> lock(shard.entries_mutex);
+    ++shard.version;
+    return shard.entries.insert_or_assign(move(key), move(value)).second;
+  }
+
+  /**
+   * @brief Calls f with the value of key under the shard's write lock,
+   * inserting a default value first if key is not in the map.
+   */
+  template <typename F>
+  void update(const Key& key, F f)
+  {
+    Shard&                   shard = shard_of(key);
+    lock_guard<shared_mutex> lock(shard.entries_mutex);
+    ++shard.version;
+    f(shard.entries[key]);
+  }
+
+  bool erase(const Key& key)
+  {
+    Shard&                   shard = shard_of(key);
+    lock_guard<shared_mutex> lock(shard.entries_mutex);
+    ++shard.version;
+    return shard.entries.erase(key) != 0;
+  }
+
+  size_t size() const
+  {
+    size_t total = 0;
+    for (size_t s = 0; s <= mask_; ++s) {
+      shared_lock<shared_mutex> lock(shards_[s].entries_mutex);
+      total += shards_[s].entries.size();
+    }
+    return total;
+  }
+
+  /**
+   * @brief Looks up every key of keys, with all their shards read-locked
+   * together.
+   *
+   * @return vector<optional<Value>> The value of each key, in the order of
+   * keys.
+   */
+  vector<optional<Value>> find_many(const vector<Key>& keys) const
+  {
+    vector<optional<Value>> values(keys.size());
+    for_each_shard<shared_lock<shared_mutex>>(keys.size(), [&](size_t i) -> const Key& { return keys[i]; },
+                                              [&](const Shard& shard, const size_t* first, const size_t* last) {
+                                                for (; first != last; ++first) {
+                                                  auto it = shard.entries.find(keys[*first]);
+                                                  if (it != shard.entries.end()) {
+                                                    values[*first] = it->second;
+                                                  }
+                                                }
+                                              });
+    return values;
+  }
+
+  /**
+   * @brief Inserts or assigns every entry of entries, with all their shards
+   * write-locked together. If a key appears more than once, its last value is
+   * kept.
+   *
+   * @return size_t The number of keys that were inserted.
+   */
+  size_t insert_many(vector<pair<Key, Value>> entries)
+  {
+    size_t inserted = 0;
+    for_each_shard<unique_lock<shared_mutex>>(entries.size(), [&](size_t i) -> const Key& { return entries[i].first; },
+                                              [&](Shard& shard, const size_t* first, const size_t* last) {
+                                                ++shard.version;
+                                                for (; first != last; ++first) {
+                                                  auto& entry = entries[*first];
+                                                  inserted += shard.entries.insert_or_assign(move(entry.first), move(entry.second)).second;
+                                                }
+                                              });
+    return inserted;
+  }
+
+  /**
+   * @brief Erases every key of keys, with all their shards write-locked
+   * together.
+   *
+   * @return size_t The number of keys that were erased.
+   */
+  size_t erase_many(const vector<Key>& keys)
+  {
+    size_t erased = 0;
+    for_each_shard<unique_lock<shared_mutex>>(keys.size(), [&](size_t i) -> const Key& { return keys[i]; },
+                                              [&](Shard& shard, const size_t* first, const size_t* last) {
+                                                ++shard.version;
+                                                for (; first != last; ++first) {
+                                                  erased += shard.entries.erase(keys[*first]);
+                                                }
+                                              });
+    return erased;
+  }
+
+  /**
+   * @brief Returns an immutable copy of the map.
+   *
+   * All the shards are read-locked together, so the snapshot is one state of
+   * the whole map. Each shard keeps its last copy and only copies itself
+   * again if it was written since.
+   */
+  Snapshot snapshot() const
+  {
+    vector<shared_lock<shared_mutex>> locks;
+    locks.reserve(mask_ + 1);
+    for (size_t s = 0; s <= mask_; ++s) {
+      locks.emplace_back(shards_[s].entries_mutex);
+    }
+
+    Snapshot result(hash_, mask_);
+    result.shards_.reserve(mask_ + 1);
+    for (size_t s = 0; s <= mask_; ++s) {
+      const Shard&      shard = shards_[s];
+      lock_guard<mutex> lock(shard.cache_mutex); // Two snapshots may refresh the same cache
+      if (!shard.cache || shard.cache_version != shard.version) {
+        shard.cache         = make_shared<const map_type>(shard.entries);
+        shard.cache_version = shard.version;
+      }
+      result.shards_.push_back(shard.cache);
+    }
+    return result;
+  }
+
+private:
+  struct alignas(64) Shard // One cache line each, so locking a shard does not slow down its neighbours
+  {
+    mutable shared_mutex entries_mutex;
+    map_type             entries;
+    uint64_t             version = 0; // Incremented by every write, under the write lock
+
+    mutable mutex                      cache_mutex;
+    mutable shared_ptr<const map_type> cache; // Copy of entries at cache_version
+    mutable uint64_t                   cache_version = 0;
+  };
+
+  static size_t shard_index(const Hash& hash, size_t mask, const Key& key)
+  {
+    return static_cast<size_t>((uint64_t(hash(key)) * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+  }
+
+  Shard& shard_of(const Key& key)
+  {
+    return shards_[shard_index(hash_, mask_, key)];
+  }
+
+  const Shard& shard_of(const Key& key) const
+  {
+    return shards_[shard_index(hash_, mask_, key)];
+  }
+
+  /**
+   * @brief Sorts the positions 0..count-1 by the shard of key_of(i), locks
+   * every shard found with a Lock, in increasing order, and then calls
+   * f(shard, first, last) once per shard with the positions of its keys.
+   * The const version hands out const shards, for read locks.
+   */
+  template <typename Lock, typename KeyOf, typename F>
+  void for_each_shard(size_t count, KeyOf key_of, F f)
+  {
+    for_each_shard_in<Lock>(shards_.get(), count, key_of, f);
+  }
+
+  template <typename Lock, typename KeyOf, typename F>
+  void for_each_shard(size_t count, KeyOf key_of, F f) const
+  {
+    for_each_shard_in<Lock>(static_cast<const Shard*>(shards_.get()), count, key_of, f);
+  }
+
+  template <typename Lock, typename ShardT, typename KeyOf, typename F>
+  void for_each_shard_in(ShardT* shards, size_t count, KeyOf key_of, F f) const
+  {
+    vector<pair<size_t, size_t>> order(count); // (shard, position)
+    for (size_t i = 0; i < count; ++i) {
+      order[i] = {shard_index(hash_, mask_, key_of(i)), i};
+    }
+    sort(order.begin(), order.end());
+
+    vector<size_t> positions(count);
+    vector<Lock>   locks;
+    for (size_t i = 0; i < count; ++i) {
+      positions[i] = order[i].second;
+      if (i == 0 || order[i].first != order[i - 1].first) {
+        locks.emplace_back(shards[order[i].first].entries_mutex);
+      }
+    }
+    for (size_t first = 0; first < count;) {
+      size_t last = first;
+      while (last < count && order[last].first == order[first].first) {
+        ++last;
+      }
+      f(shards[order[first].first], positions.data() + first, positions.data() + last);
+      first = last;
+    }
+  }
+
+  Hash                hash_;
+  size_t              mask_ = 0;
+  unique_ptr<Shard[]> shards_;
+};
+
+/**
+ * @brief std::map protected by a mutex, the usual way of sharing a map
+ * between threads. Used as the reference in the benchmark.
+ */
+template <typename Key, typename Value>
+class LockedMap
+{
+public:
+  optional<Value> find(const Key& key) const
+  {
+    lock_guard<mutex> lock(mutex_);
+    auto              it = map_.find(key);
+    if (it == map_.end()) {
+      return nullopt;
+    }
+    return it->second;
+  }
+
+  bool insert_or_assign(Key key, Value value)
+  {
+    lock_guard<mutex> lock(mutex_);
+    return map_.insert_or_assign(move(key), move(value)).second;
+  }
+
+private:
+  mutable mutex   mutex_;
+  map<Key, Value> map_;
+};
+
+using CustomShardedMap = ShardedMap<CustomKey, CustomValue, CustomKeyHash>;
+
+/**
+ * @brief Prints the entries of a snapshot, in the same format as print_map()
+ * in maps.cpp. The entries come shard by shard.
+ */
+void print_map(const CustomShardedMap::Snapshot& snapshot)
+{
+  snapshot.for_each([](const CustomKey& key, const CustomValue& value) {
+    cout << "Name: " << key.name << " ID(" << key.id << ") -> Age: " << value.age << ", Address: " << value.address << '\n';
+  });
+}
+
+/**
+ * @brief Same operations as the menu of maps.cpp, on a CustomShardedMap.
+ */
+void basic_sharded_map()
+{
+  CustomShardedMap m(4);
+  // Predefine
+  m.insert_many({{CustomKey(1, "Alice"), CustomValue(25, "123 Main St")},
+                 {CustomKey(2, "Bob"), CustomValue(30, "456 Elm St")},
+                 {CustomKey(3, "Charlie"), CustomValue(35, "789 Oak St")}});
+  auto before = m.snapshot();
+
+  m.update(CustomKey(2, "Bob"), [](CustomValue& value) { value.address = "1 New St"; });
+  m.erase(CustomKey(3, "Charlie"));
+  if (auto value = m.find(CustomKey(2, "Bob"))) {
+    cout << "Found ID: 2 Name: Bob -> Age: " << value->age << ", Address: " << value->address << '\n';
+  }
+
+  cout << "Snapshot taken before the changes:\n";
+  print_map(before);
+  cout << "Snapshot taken after the changes:\n";
+  print_map(m.snapshot());
+}
+
+/**
+ * @brief Writers insert and erase their own keys, by single operations and
+ * by batches, while readers take snapshots. Checks that every snapshot holds
+ * whole batches and that the final map has the expected entries.
+ *
+ * @return bool True if every check passed.
+ */
+bool stress_test(unsigned writers, unsigned readers, int per_writer)
+{
+  CustomShardedMap m(16);
+  atomic<unsigned> writers_left{writers};
+  atomic<bool>     ok{true};
+  vector<thread>   threads;
+
+  for (unsigned w = 0; w < writers; ++w) {
+    threads.emplace_back([&, w] {
+      int base = static_cast<int>(w) * per_writer;
+      for (int i = 0; i < per_writer; i += 2) {
+        // Pairs of keys with the same name go in one batch, so a snapshot must
+        // see both or neither. Half of the pairs are then changed key by key
+        string name = "pair-" + to_string(base + i);
+        m.insert_many({{CustomKey(base + i, name), CustomValue(i, "a")}, {CustomKey(base + i + 1, name), CustomValue(i, "b")}});
+        if (i % 4 == 0) {
+          m.erase(CustomKey(base + i, name));
+          m.insert_or_assign(CustomKey(base + i, name), CustomValue(i, "c"));
+        }
+      }
+      --writers_left;
+    });
+  }
+  for (unsigned r = 0; r < readers; ++r) {
+    threads.emplace_back([&] {
+      while (writers_left > 0) {
+        auto snapshot = m.snapshot();
+        snapshot.for_each([&](const CustomKey& key, const CustomValue&) {
+          int partner = key.id % 2 == 0 ? key.id + 1 : key.id - 1;
+          if (key.id % 4 >= 2 && snapshot.find(CustomKey(partner, key.name)) == nullptr) { // Pairs not changed by single operations
+            ok = false; // Half of a batch
+          }
+        });
+      }
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+
+  bool final_ok = m.size() == size_t(writers) * size_t(per_writer);
+  for (unsigned w = 0; final_ok && w < writers; ++w) {
+    for (int i = 0; i < per_writer; ++i) {
+      int  id    = static_cast<int>(w) * per_writer + i;
+      auto value = m.find(CustomKey(id, "pair-" + to_string(id - id % 2)));
+      final_ok   = value && value->address == (i % 2 == 1 ? "b" : i % 4 == 0 ? "c" : "a");
+    }
+  }
+  cout << "Stress test, " << writers << " writers and " << readers << " readers: " << (ok && final_ok ? "consistent" : "INCONSISTENT") << '\n';
+  return ok && final_ok;
+}
+
+atomic<size_t> lookups_found{0};
+
+/**
+ * @brief Every thread does ops operations on random keys of a shared map:
+ * 95% lookups and 5% insertions or assignments.
+ *
+ * @return double Millions of operations per second.
+ */
+template <typename Map>
+double throughput(Map& m, const vector<CustomKey>& keys, unsigned num_threads, size_t ops)
+{
+  vector<thread> threads;
+  auto           start = chrono::steady_clock::now();
+  for (unsigned t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&m, &keys, ops, t] {
+      mt19937 rng(t);
+      size_t  found = 0;
+      for (size_t i = 0; i < ops; ++i) {
+        const CustomKey& key = keys[rng() % keys.size()];
+        if (rng() % 100 < 5) {
+          m.insert_or_assign(key, CustomValue(static_cast<int>(i % 100), "Street"));
+        }
+        else {
+          found += m.find(key).has_value();
+        }
+      }
+      lookups_found += found; // Keeps the lookups from being optimized away
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+  double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+  return static_cast<double>(num_threads * ops) / seconds / 1e6;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The total number of operations of each benchmark run and the largest
+ * number of threads can be passed as the first and second arguments.
+ *
+ * @return int Returns 0 if the stress tests pass.
+ */
+int main(int argc, char* argv[])
+{
+  basic_sharded_map();
+
+  size_t   ops         = argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000;
+  unsigned max_threads = argc > 2 ? static_cast<unsigned>(strtoul(argv[2], nullptr, 10)) : 64;
+  bool     ok          = stress_test(1, 1, 20000) && stress_test(4, 2, 5000) && stress_test(8, 4, 2000);
+
+  vector<CustomKey> keys;
+  for (int i = 0; i < 100000; ++i) {
+    keys.emplace_back(i, "name-" + to_string(i % 1000));
+  }
+  CustomShardedMap                  sharded(4 * max<size_t>(max_threads, thread::hardware_concurrency()));
+  LockedMap<CustomKey, CustomValue> locked;
+  for (const auto& key : keys) {
+    sharded.insert_or_assign(key, CustomValue(key.id % 100, "Street"));
+    locked.insert_or_assign(key, CustomValue(key.id % 100, "Street"));
+  }
+
+  cout << "\nThroughput with 95% reads (millions of operations per second), " << sharded.shard_count() << " shards" << '\n';
+  for (unsigned t = 1; t <= max(1u, max_threads); t *= 2) {
+    cout << t << " threads: ShardedMap " << throughput(sharded, keys, t, ops / t) << ", mutex + map " << throughput(locked, keys, t, ops / t) << '\n';
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,633 @@
+/**
+ * @file soa_vector.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Structure-of-arrays container as an alternative to
+ * std::vector<pair<int, string>>.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * A vector<pair<int, string>> stores every int next to a 32 byte string, so a
+ * loop that only reads the ints still pulls the strings through the cache.
+ * soa_vector<int, string> stores each member in its own std::vector. Elements
+ * are accessed through a proxy that refers to one slot of every column, and
+ * the iterators work with the standard algorithms.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Proxy for one element of a soa_vector.
+ *
+ * Holds a reference to the element's slot in every column. Assigning to the
+ * proxy assigns through to the columns, and converting it to a tuple copies
+ * the values out. It supports structured bindings, which bind to the column
+ * slots themselves.
+ *
+ * Like a reference passed to std::move, an rvalue proxy gives its values
+ * away: converting or assigning from it moves the members. The algorithms
+ * move elements with std::move(*it), so std::sort over the iterators moves
+ * the strings instead of copying them. Name the proxy to copy from it.
+ *
+ * @tparam Refs Reference type of each column, T& or const T&.
+ */
+template <typename... Refs>
+class soa_ref
+{
+public:
+  using value_type = tuple<decay_t<Refs>...>;
+
+  explicit soa_ref(Refs... refs) : refs_(refs...)
+  {
+  }
+
+  soa_ref(const soa_ref&) = default;
+
+  /**
+   * @brief Returns a reference to the I-th member of the element.
+   */
+  template <size_t I>
+  tuple_element_t<I, tuple<Refs...>> get() const
+  {
+    return std::get<I>(refs_);
+  }
+
+  /**
+   * @brief Copies the values of the element into a tuple.
+   */
+  operator value_type() const&
+  {
+    return value_type(refs_);
+  }
+
+  /**
+   * @brief Moves the values of the element into a tuple.
+   */
+  operator value_type() &&
+  {
+    return move_members(index_sequence_for<Refs...>());
+  }
+
+  /**
+   * @brief Copies the values of another element into this one.
+   */
+  soa_ref& operator=(const soa_ref& other)
+  {
+    refs_ = other.refs_;
+    return *this;
+  }
+
+  /**
+   * @brief Moves the values of another element into this one.
+   */
+  soa_ref& operator=(soa_ref&& other)
+  {
+    assign_members(other, index_sequence_for<Refs...>());
+    return *this;
+  }
+
+  soa_ref& operator=(const value_type& value)
+  {
+    refs_ = value;
+    return *this;
+  }
+
+  soa_ref& operator=(value_type&& value)
+  {
+    refs_ = move(value);
+    return *this;
+  }
+
+  /**
+   * @brief Swaps the values of two elements, member by member.
+   */
+  friend void swap(soa_ref a, soa_ref b)
+  {
+    swap_members(a, b, index_sequence_for<Refs...>());
+  }
+
+  friend bool operator==(const soa_ref& a, const soa_ref& b)
+  {
+    return a.refs_ == b.refs_;
+  }
+  friend bool operator!=(const soa_ref& a, const soa_ref& b)
+  {
+    return a.refs_ != b.refs_;
+  }
+  friend bool operator<(const soa_ref& a, const soa_ref& b)
+  {
+    return a.refs_ < b.refs_;
+  }
+  // Mixed comparisons, used by algorithms that hold one element in a temporary
+  friend bool operator<(const soa_ref& a, const value_type& b)
+  {
+    return a.refs_ < b;
+  }
+  friend bool operator<(const value_type& a, const soa_ref& b)
+  {
+    return a < b.refs_;
+  }
+
+private:
+  template <size_t... I>
+  value_type move_members(index_sequence<I...>)
+  {
+    return value_type(move(std::get<I>(refs_))...);
+  }
+
+  template <size_t... I>
+  void assign_members(soa_ref& other, index_sequence<I...>)
+  {
+    ((std::get<I>(refs_) = move(std::get<I>(other.refs_))), ...);
+  }
+
+  template <size_t... I>
+  static void swap_members(soa_ref& a, soa_ref& b, index_sequence<I...>)
+  {
+    using std::swap;
+    (swap(std::get<I>(a.refs_), std::get<I>(b.refs_)), ...);
+  }
+
+  tuple<Refs...> refs_;
+};
+
+namespace std
+{
+template <typename... Refs>
+struct tuple_size<soa_ref<Refs...>> : integral_constant<size_t, sizeof...(Refs)>
+{
+};
+
+template <size_t I, typename... Refs>
+struct tuple_element<I, soa_ref<Refs...>>
+{
+  using type = tuple_element_t<I, tuple<Refs...>>;
+};
+} // namespace std
+
+/**
+ * @brief Sequence container that stores each member of its elements in a
+ * separate contiguous array.
+ *
+ * @tparam Ts Type of each member (column).
+ */
+template <typename... Ts>
+class soa_vector
+{
+public:
+  using value_type      = tuple<Ts...>;
+  using size_type       = size_t;
+  using reference       = soa_ref<Ts&...>;
+  using const_reference = soa_ref<const Ts&...>;
+
+  /**
+   * @brief Random access iterator whose reference type is the element proxy.
+   */
+  template <bool Const>
+  class basic_iterator
+  {
+  public:
+    using container         = conditional_t<Const, const soa_vector, soa_vector>;
+    using iterator_category = random_access_iterator_tag;
+    using value_type        = soa_vector::value_type;
+    using difference_type   = ptrdiff_t;
+    using pointer           = void;
+    using reference         = conditional_t<Const, soa_vector::const_reference, soa_vector::reference>;
+
+    basic_iterator() = default;
+    basic_iterator(container* owner, size_t index) : owner_(owner), index_(index)
+    {
+    }
+    // An iterator converts to a const_iterator, not the other way around.
+    template <bool OtherConst, typename = enable_if_t<Const && !OtherConst>>
+    basic_iterator(const basic_iterator<OtherConst>& other) : owner_(other.owner_), index_(other.index_)
+    {
+    }
+
+    reference operator*() const
+    {
+      return (*owner_)[index_];
+    }
+    reference operator[](difference_type n) const
+    {
+      return (*owner_)[index_ + static_cast<size_t>(n)];
+    }
+
+    basic_iterator& operator++()
+    {
+      ++index_;
+      return *this;
+    }
+    basic_iterator operator++(int)
+    {
+      basic_iterator old = *this;
+      ++index_;
+      return old;
+    }
+    basic_iterator& operator--()
+    {
+      --index_;
+      return *this;
+    }
+    basic_iterator operator--(int)
+    {
+      basic_iterator old = *this;
+      --index_;
+      return old;
+    }
+    basic_iterator& operator+=(difference_type n)
+    {
+      index_ += static_cast<size_t>(n);
+      return *this;
+    }
+    basic_iterator& operator-=(difference_type n)
+    {
+      index_ -= static_cast<size_t>(n);
+      return *this;
+    }
+    friend basic_iterator operator+(basic_iterator it, difference_type n)
+    {
+      return it += n;
+    }
+    friend basic_iterator operator+(difference_type n, basic_iterator it)
+    {
+      return it += n;
+    }
+    friend basic_iterator operator-(basic_iterator it, difference_type n)
+    {
+      return it -= n;
+    }
+    friend difference_type operator-(const basic_iterator& a, const basic_iterator& b)
+    {
+      return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+    }
+
+    friend bool operator==(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ == b.index_;
+    }
+    friend bool operator!=(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ != b.index_;
+    }
+    friend bool operator<(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ < b.index_;
+    }
+    friend bool operator>(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ > b.index_;
+    }
+    friend bool operator<=(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ <= b.index_;
+    }
+    friend bool operator>=(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ >= b.index_;
+    }
+
+  private:
+    template <bool>
+    friend class basic_iterator;
+
+    container* owner_ = nullptr;
+    size_t     index_ = 0;
+  };
+
+  using iterator       = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  soa_vector() = default;
+
+  soa_vector(initializer_list<value_type> values)
+  {
+    reserve(values.size());
+    for (const auto& value : values) {
+      push_back(value);
+    }
+  }
+
+  size_t size() const
+  {
+    return std::get<0>(columns_).size();
+  }
+
+  bool empty() const
+  {
+    return size() == 0;
+  }
+
+  /**
+   * @brief Returns the array that holds the I-th member of every element.
+   *
+   * Loops and algorithms that only need one member should run over this array
+   * directly; they do not touch the other columns at all.
+   */
+  template <size_t I>
+  vector<tuple_element_t<I, value_type>>& column()
+  {
+    return std::get<I>(columns_);
+  }
+
+  template <size_t I>
+  const vector<tuple_element_t<I, value_type>>& column() const
+  {
+    return std::get<I>(columns_);
+  }
+
+  reference operator[](size_t index)
+  {
+    return element<reference>(columns_, index, index_sequence_for<Ts...>());
+  }
+
+  const_reference operator[](size_t index) const
+  {
+    return element<const_reference>(columns_, index, index_sequence_for<Ts...>());
+  }
+
+  /**
+   * @brief Returns the element at the given position.
+   *
+   * @throws std::out_of_range if index is not smaller than size().
+   */
+  reference at(size_t index)
+  {
+    if (index >= size()) {
+      throw out_of_range("soa_vector::at: index out of range");
+    }
+    return (*this)[index];
+  }
+
+  const_reference at(size_t index) const
+  {
+    if (index >= size()) {
+      throw out_of_range("soa_vector::at: index out of range");
+    }
+    return (*this)[index];
+  }
+
+  iterator begin()
+  {
+    return iterator(this, 0);
+  }
+  iterator end()
+  {
+    return iterator(this, size());
+  }
+  const_iterator begin() const
+  {
+    return const_iterator(this, 0);
+  }
+  const_iterator end() const
+  {
+    return const_iterator(this, size());
+  }
+
+  void reserve(size_t n)
+  {
+    apply([n](auto&... columns) { (columns.reserve(n), ...); }, columns_);
+  }
+
+  void resize(size_t n)
+  {
+    apply([n](auto&... columns) { (columns.resize(n), ...); }, columns_);
+  }
+
+  void clear()
+  {
+    apply([](auto&... columns) { (columns.clear(), ...); }, columns_);
+  }
+
+  void shrink_to_fit()
+  {
+    apply([](auto&... columns) { (columns.shrink_to_fit(), ...); }, columns_);
+  }
+
+  /**
+   * @brief Appends an element built from one argument per member.
+   */
+  template <typename... Args, typename = enable_if_t<sizeof...(Args) == sizeof...(Ts)>>
+  void emplace_back(Args&&... args)
+  {
+    emplace_members(index_sequence_for<Ts...>(), forward<Args>(args)...);
+  }
+
+  void push_back(const value_type& value)
+  {
+    apply([this](const auto&... members) { emplace_back(members...); }, value);
+  }
+
+  void push_back(value_type&& value)
+  {
+    apply([this](auto&... members) { emplace_back(move(members)...); }, value);
+  }
+
+  void pop_back()
+  {
+    apply([](auto&... columns) { (columns.pop_back(), ...); }, columns_);
+  }
+
+  /**
+   * @brief Removes the element at the given position.
+   */
+  void erase(size_t index)
+  {
+    apply([index](auto&... columns) { (columns.erase(columns.begin() + static_cast<ptrdiff_t>(index)), ...); }, columns_);
+  }
+
+  /**
+   * @brief Stable sort of the elements by their I-th member.
+   *
+   * Column I is sorted as (key, position) pairs, so the comparisons read the
+   * keys next to each other, and ties are broken by position to keep the sort
+   * stable. The keys are written back in order, and the other columns are
+   * rearranged with one pass each over the sorted positions.
+   *
+   * @tparam I Index of the member to sort by.
+   * @param comp Strict weak ordering over that member.
+   */
+  template <size_t I, typename Compare = less<>>
+  void sort_by(Compare comp = Compare())
+  {
+    using key_type = tuple_element_t<I, value_type>;
+    auto& keys     = column<I>();
+
+    vector<pair<key_type, size_t>> sorted;
+    sorted.reserve(size());
+    for (size_t i = 0; i < size(); ++i) {
+      sorted.emplace_back(move(keys[i]), i);
+    }
+    sort(sorted.begin(), sorted.end(), [&](const auto& a, const auto& b) {
+      return comp(a.first, b.first) || (!comp(b.first, a.first) && a.second < b.second);
+    });
+
+    vector<size_t> order(size());
+    for (size_t i = 0; i < size(); ++i) {
+      keys[i]  = move(sorted[i].first);
+      order[i] = sorted[i].second;
+    }
+    permute_others<I>(order, index_sequence_for<Ts...>());
+  }
+
+private:
+  template <typename Ref, typename Columns, size_t... I>
+  static Ref element(Columns& columns, size_t index, index_sequence<I...>)
+  {
+    return Ref(std::get<I>(columns)[index]...);
+  }
+
+  template <size_t... I, typename... Args>
+  void emplace_members(index_sequence<I...>, Args&&... args)
+  {
+    (std::get<I>(columns_).emplace_back(forward<Args>(args)), ...);
+  }
+
+  template <size_t Skip, size_t... I>
+  void permute_others(const vector<size_t>& order, index_sequence<I...>)
+  {
+    ((I == Skip ? void() : permute(std::get<I>(columns_), order)), ...);
+  }
+
+  template <typename T>
+  static void permute(vector<T>& column, const vector<size_t>& order)
+  {
+    vector<T> reordered;
+    reordered.reserve(column.size());
+    for (size_t index : order) {
+      reordered.push_back(move(column[index]));
+    }
+    column.swap(reordered);
+  }
+
+  tuple<vector<Ts>...> columns_;
+};
+
+/**
+ * @brief Prints the contents of a soa_vector of (int, string) elements, in
+ * the same format as print_vector() for vector<pair<int, string>>.
+ */
+void print_vector(const soa_vector<int, string>& v)
+{
+  cout << '\n';
+  for (auto elem : v) {
+    cout << elem.get<0>() << ": " << elem.get<1>() << '\n';
+  }
+}
+
+/**
+ * @brief Shows that the container behaves like a vector of pairs.
+ *
+ * Covers initialization, structured bindings, assignment through the proxy,
+ * standard algorithms on the iterators and sorting by one member.
+ */
+void basic_soa_vector()
+{
+  soa_vector<int, string> pairs = {{3, "three"}, {1, "one"}, {2, "two"}};
+  print_vector(pairs);
+
+  // Structured bindings refer to the slots inside the columns
+  auto [id, name] = pairs[0];
+  id              = 30;
+  name            = "thirty";
+  pairs.push_back({4, "four"});
+  print_vector(pairs);
+
+  auto it = find_if(pairs.begin(), pairs.end(), [](auto elem) { return elem.template get<1>() == "two"; });
+  cout << "\nfind_if found \"two\" at position " << (it - pairs.begin()) << '\n';
+
+  cout << "\nstd::sort over the proxies:";
+  sort(pairs.begin(), pairs.end());
+  print_vector(pairs);
+
+  cout << "\nsort_by<1> (name column):";
+  pairs.sort_by<1>();
+  print_vector(pairs);
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Compares a key-only scan and a sort by key on a
+ * vector<pair<int, string>> and on a soa_vector<int, string>.
+ *
+ * @param n Number of elements.
+ * @return bool True if both hold the same elements in the same order.
+ */
+bool benchmark(size_t n)
+{
+  mt19937                   rng(3);
+  vector<pair<int, string>> pairs;
+  soa_vector<int, string>   soa;
+  pairs.reserve(n);
+  soa.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    int key = static_cast<int>(rng() % 1000000);
+    pairs.emplace_back(key, "value number " + to_string(i));
+    soa.emplace_back(key, "value number " + to_string(i));
+  }
+
+  long long pairs_sum = 0;
+  long long soa_sum   = 0;
+  cout << "\nBenchmark with " << n << " elements" << '\n';
+  cout << "Key scan vector<pair>: " << time_ms([&] {
+    for (const auto& elem : pairs) {
+      pairs_sum += elem.first;
+    }
+  }) << " ms\n";
+  cout << "Key scan soa_vector:   " << time_ms([&] {
+    for (int key : soa.column<0>()) {
+      soa_sum += key;
+    }
+  }) << " ms\n";
+
+  cout << "Sort by key vector<pair>: " << time_ms([&] {
+    stable_sort(pairs.begin(), pairs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+  }) << " ms\n";
+  cout << "Sort by key soa_vector:   " << time_ms([&] { soa.sort_by<0>(); }) << " ms\n";
+
+  bool same = pairs_sum == soa_sum;
+  for (size_t i = 0; same && i < n; ++i) {
+    same = pairs[i].first == soa[i].get<0>() && pairs[i].second == soa[i].get<1>();
+  }
+  cout << "Same contents: " << (same ? "yes" : "no") << '\n';
+  return same;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of elements of the benchmark can be passed as the first argument.
+ *
+ * @return int Returns 0 if the vector and the soa_vector ended with the same
+ * contents.
+ */
+int main(int argc, char* argv[])
+{
+  basic_soa_vector();
+  bool ok = benchmark(argc > 1 ? strtoull(argv[1], nullptr, 10) : 2000000);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,305 @@
+/**
+ * @file static_map.h
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Map of a fixed set of keys, built at compile time with a perfect
+ * hash.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * Some key sets are known when the program is written, such as the names of
+ * the "Predefine" option of maps.cpp or the error codes of
+ * exceptions/basic_exceptions.cpp. For those, make_static_map() builds a
+ * table where no two keys share a slot. When the result is declared
+ * constexpr, the compiler does all the work and the table goes into the
+ * read-only data of the program, so nothing runs at startup.
+ *
+ * The table uses hash and displace. Each key has one 64-bit hash. Its high
+ * bits choose a bucket, and each bucket has a seed that was picked so that
+ * the keys of all buckets land on different slots. Buckets are placed
+ * largest first while the table still has room. A lookup hashes the key once,
+ * mixes the hash with the seed of its bucket and compares the key stored in
+ * the slot it lands on.
+ *
+ * Keys can be strings (anything convertible to std::string_view), integers or
+ * enums. Repeated keys make the build fail: at compile time this is an error
+ * of the constant expression, and at run time it throws
+ * std::invalid_argument.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef STATIC_MAP_H
+#define STATIC_MAP_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+namespace static_map_detail
+{
+
+/**
+ * @brief Final mix of splitmix64: every bit of the input changes about half
+ * the bits of the result.
+ */
+constexpr uint64_t mix(uint64_t h)
+{
+  h ^= h >> 30;
+  h *= 0xBF58476D1CE4E5B9ull;
+  h ^= h >> 27;
+  h *= 0x94D049BB133111EBull;
+  h ^= h >> 31;
+  return h;
+}
+
+/**
+ * @brief Hash of a key: FNV-1a of the characters of a string, or the value of
+ * an integer or enum, mixed.
+ */
+template <typename Key>
+constexpr uint64_t hash_key(const Key& key)
+{
+  if constexpr (std::is_convertible_v<const Key&, std::string_view>) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (char c : std::string_view(key)) {
+      h = (h ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+    }
+    return mix(h);
+  }
+  else {
+    static_assert(std::is_integral_v<Key> || std::is_enum_v<Key>, "StaticMap keys must be strings, integers or enums");
+    return mix(static_cast<uint64_t>(key));
+  }
+}
+
+/**
+ * @brief Whether two keys are equal. Strings are compared by their
+ * characters, as hash_key() reads them, so const char* keys are not compared
+ * as pointers.
+ */
+template <typename Key>
+constexpr bool keys_equal(const Key& a, const Key& b)
+{
+  if constexpr (std::is_convertible_v<const Key&, std::string_view>) {
+    return std::string_view(a) == std::string_view(b);
+  }
+  else {
+    return a == b;
+  }
+}
+
+/**
+ * @brief Smallest power of two not below n.
+ */
+constexpr size_t ceil_pow2(size_t n)
+{
+  size_t p = 1;
+  while (p < n) {
+    p *= 2;
+  }
+  return p;
+}
+
+} // namespace static_map_detail
+
+/**
+ * @brief A key and its value, as stored in a StaticMap.
+ */
+template <typename Key, typename Value>
+struct StaticEntry
+{
+  Key   key{};
+  Value value{};
+};
+
+/**
+ * @brief Read-only map of N keys with a perfect hash.
+ *
+ * @tparam Key   Key type: a string view, an integer or an enum.
+ * @tparam Value Mapped type. It must be usable in constant expressions for
+ *               the map to be constexpr.
+ * @tparam N     Number of entries.
+ */
+template <typename Key, typename Value, size_t N>
+class StaticMap
+{
+  static_assert(N > 0, "A StaticMap needs at least one entry");
+
+public:
+  using value_type     = StaticEntry<Key, Value>;
+  using const_iterator = const value_type*;
+
+  static constexpr size_t table_size  = static_map_detail::ceil_pow2(N);
+  static constexpr size_t bucket_size = table_size / 2 > 0 ? table_size / 2 : 1;
+
+  /**
+   * @brief Builds the table. Use make_static_map() to have N deduced.
+   *
+   * @throws std::invalid_argument If a key is repeated, or no seed could be
+   * found for a bucket.
+   */
+  constexpr explicit StaticMap(const value_type (&entries)[N]) : entries_(), slots_(), seeds_()
+  {
+    for (size_t i = 0; i < N; ++i) {
+      entries_[i] = entries[i];
+    }
+
+    // Entries grouped by bucket with a counting sort
+    std::array<uint64_t, N>             hashes{};
+    std::array<size_t, bucket_size + 1> starts{};
+    std::array<uint32_t, N>             by_bucket{};
+    for (size_t i = 0; i < N; ++i) {
+      hashes[i] = static_map_detail::hash_key(entries_[i].key);
+      ++starts[bucket_of(hashes[i]) + 1];
+    }
+    for (size_t b = 0; b < bucket_size; ++b) {
+      starts[b + 1] += starts[b];
+    }
+    std::array<size_t, bucket_size> fill{};
+    for (size_t i = 0; i < N; ++i) {
+      size_t b                         = bucket_of(hashes[i]);
+      by_bucket[starts[b] + fill[b]++] = static_cast<uint32_t>(i);
+    }
+
+    // Buckets by decreasing size (insertion sort: N is small)
+    std::array<uint32_t, bucket_size> order{};
+    for (size_t b = 0; b < bucket_size; ++b) {
+      size_t j = b;
+      while (j > 0 && starts[order[j - 1] + 1] - starts[order[j - 1]] < starts[b + 1] - starts[b]) {
+        order[j] = order[j - 1];
+        --j;
+      }
+      order[j] = static_cast<uint32_t>(b);
+    }
+
+    std::array<bool, table_size> taken{};
+    for (size_t b : order) {
+      size_t first = starts[b], last = starts[b + 1];
+      if (first == last) {
+        break; // The rest of the buckets are empty
+      }
+      for (size_t i = first; i < last; ++i) {
+        for (size_t j = first; j < i; ++j) {
+          if (static_map_detail::keys_equal(entries_[by_bucket[i]].key, entries_[by_bucket[j]].key)) {
+            throw std::invalid_argument("StaticMap: repeated key");
+          }
+        }
+      }
+
+      uint32_t seed = 0;
+      while (!fits(seed, hashes, by_bucket, first, last, taken)) {
+        if (++seed == max_seed) {
+          throw std::invalid_argument("StaticMap: no perfect hash found");
+        }
+      }
+      seeds_[b] = seed;
+      for (size_t i = first; i < last; ++i) {
+        size_t slot  = slot_of(hashes[by_bucket[i]], seed);
+        taken[slot]  = true;
+        slots_[slot] = by_bucket[i];
+      }
+    }
+    // Empty slots keep entry 0. A key that lands on one can not be the key of
+    // entry 0, which has its own slot, so the comparison in find() fails.
+  }
+
+  /**
+   * @brief Returns the value of key, or nullptr if key is not in the map.
+   */
+  constexpr const Value* find(const Key& key) const
+  {
+    uint64_t          h     = static_map_detail::hash_key(key);
+    const value_type& entry = entries_[slots_[slot_of(h, seeds_[bucket_of(h)])]];
+    return static_map_detail::keys_equal(entry.key, key) ? &entry.value : nullptr;
+  }
+
+  constexpr bool contains(const Key& key) const
+  {
+    return find(key) != nullptr;
+  }
+
+  /**
+   * @brief Returns the value of key.
+   *
+   * @throws std::out_of_range If key is not in the map.
+   */
+  constexpr const Value& at(const Key& key) const
+  {
+    const Value* value = find(key);
+    if (value == nullptr) {
+      throw std::out_of_range("StaticMap: key not found");
+    }
+    return *value;
+  }
+
+  static constexpr size_t size()
+  {
+    return N;
+  }
+
+  /**
+   * @brief The entries, in the order they were given.
+   */
+  constexpr const_iterator begin() const
+  {
+    return entries_.data();
+  }
+  constexpr const_iterator end() const
+  {
+    return entries_.data() + N;
+  }
+
+private:
+  static constexpr uint32_t max_seed = 1u << 16;
+
+  static constexpr size_t bucket_of(uint64_t h)
+  {
+    return static_cast<size_t>(h >> 32) & (bucket_size - 1);
+  }
+
+  static constexpr size_t slot_of(uint64_t h, uint32_t seed)
+  {
+    return static_cast<size_t>(static_map_detail::mix(h ^ seed)) & (table_size - 1);
+  }
+
+  /**
+   * @brief Whether seed sends the keys of a bucket to slots that are free and
+   * different from each other.
+   */
+  static constexpr bool fits(uint32_t seed, const std::array<uint64_t, N>& hashes, const std::array<uint32_t, N>& by_bucket, size_t first, size_t last,
+                             const std::array<bool, table_size>& taken)
+  {
+    for (size_t i = first; i < last; ++i) {
+      size_t slot = slot_of(hashes[by_bucket[i]], seed);
+      if (taken[slot]) {
+        return false;
+      }
+      for (size_t j = first; j < i; ++j) {
+        if (slot_of(hashes[by_bucket[j]], seed) == slot) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  std::array<value_type, N>         entries_;
+  std::array<uint32_t, table_size>  slots_; // Index in entries_ of the key of each slot
+  std::array<uint32_t, bucket_size> seeds_;
+};
+
+/**
+ * @brief Builds a StaticMap from a braced list of {key, value} pairs.
+ *
+ * constexpr auto colors = make_static_map<std::string_view, int>({{"red", 1}, {"green", 2}});
+ */
+template <typename Key, typename Value, size_t N>
+constexpr StaticMap<Key, Value, N> make_static_map(const StaticEntry<Key, Value> (&entries)[N])
+{
+  return StaticMap<Key, Value, N>(entries);
+}
+
+#endif // STATIC_MAP_H
@@ -0,0 +1,378 @@
+/**
+ * @file string_interning.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Interned names for the keys of maps.cpp: 32-bit symbols instead of
+ * std::string.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * CustomKey in maps.cpp owns a std::string, so every key with a repeated
+ * name holds its own copy, and two keys with the same id are ordered by a
+ * full string comparison. A SymbolTable keeps one copy of each distinct
+ * string and hands out a 32-bit symbol for it. InternedKey stores the symbol:
+ * comparing names for equality compares two integers, and ordering them
+ * compares two cached ranks, which follow the alphabetical order of the
+ * strings.
+ *
+ * A SymbolTable is not thread-safe. Programs that intern from several threads
+ * must use one table per thread, or protect the table with a mutex.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "custom_types.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Set of distinct strings, each one identified by a 32-bit symbol.
+ *
+ * The characters are copied once into large blocks that never move, so the
+ * string_view of a symbol stays valid as long as the table.
+ *
+ * Every symbol also has a rank: comparing the ranks of two symbols gives
+ * the same result as comparing their strings. Ranks are spread over 64 bits
+ * with gaps, so a new string takes a rank between its neighbours without
+ * changing theirs; only when a gap runs out are all the ranks renumbered,
+ * keeping their order.
+ */
+class SymbolTable
+{
+public:
+  explicit SymbolTable(size_t block_size = 64 * 1024) : block_size_(block_size)
+  {
+  }
+
+  SymbolTable(const SymbolTable&)            = delete;
+  SymbolTable& operator=(const SymbolTable&) = delete;
+
+  /**
+   * @brief Returns the symbol of text, adding text to the table if needed.
+   */
+  uint32_t intern(string_view text)
+  {
+    auto found = ids_.find(text);
+    if (found != ids_.end()) {
+      return found->second;
+    }
+
+    auto        symbol = static_cast<uint32_t>(names_.size());
+    string_view stored = store(text);
+    names_.push_back(stored);
+    ranks_.push_back(0);
+    ids_.emplace(stored, symbol);
+    assign_rank(sorted_.emplace(stored, symbol).first);
+    return symbol;
+  }
+
+  /**
+   * @brief Returns the symbol of text if it was interned before. Lookups of
+   * unknown strings do not grow the table.
+   */
+  optional<uint32_t> lookup(string_view text) const
+  {
+    auto found = ids_.find(text);
+    if (found == ids_.end()) {
+      return nullopt;
+    }
+    return found->second;
+  }
+
+  string_view name(uint32_t symbol) const
+  {
+    return names_[symbol];
+  }
+
+  uint64_t rank(uint32_t symbol) const
+  {
+    return ranks_[symbol];
+  }
+
+  size_t size() const
+  {
+    return names_.size();
+  }
+
+  /**
+   * @brief Bytes of string data held by the table.
+   */
+  size_t string_bytes() const
+  {
+    return string_bytes_;
+  }
+
+private:
+  using SortedMap = map<string_view, uint32_t>;
+
+  static constexpr uint64_t rank_step = uint64_t(1) << 32; // Gap left after the last rank
+
+  string_view store(string_view text)
+  {
+    if (blocks_.empty() || block_used_ + text.size() > block_capacity_) {
+      block_capacity_ = max(block_size_, text.size());
+      blocks_.push_back(make_unique<char[]>(block_capacity_));
+      block_used_ = 0;
+    }
+    char* destination = blocks_.back().get() + block_used_;
+    memcpy(destination, text.data(), text.size());
+    block_used_ += text.size();
+    string_bytes_ += text.size();
+    return string_view(destination, text.size());
+  }
+
+  /**
+   * @brief Gives the new entry a rank between the ranks of its neighbours in
+   * alphabetical order, renumbering everything if they leave no room.
+   */
+  void assign_rank(SortedMap::iterator entry)
+  {
+    uint64_t low  = entry == sorted_.begin() ? 0 : ranks_[prev(entry)->second];
+    uint64_t high = next(entry) == sorted_.end() ? numeric_limits<uint64_t>::max() : ranks_[next(entry)->second];
+    if (high - low < 2) {
+      renumber();
+      return;
+    }
+    ranks_[entry->second] = low + min((high - low) / 2, rank_step);
+  }
+
+  void renumber()
+  {
+    uint64_t spacing = numeric_limits<uint64_t>::max() / (sorted_.size() + 1);
+    uint64_t rank    = 0;
+    for (const auto& entry : sorted_) {
+      rank += spacing;
+      ranks_[entry.second] = rank;
+    }
+  }
+
+  size_t                               block_size_;
+  size_t                               block_capacity_ = 0;
+  size_t                               block_used_     = 0;
+  size_t                               string_bytes_   = 0;
+  vector<unique_ptr<char[]>>           blocks_;
+  vector<string_view>                  names_;
+  vector<uint64_t>                     ranks_;
+  unordered_map<string_view, uint32_t> ids_;
+  SortedMap                            sorted_;
+};
+
+/**
+ * @brief The table shared by every InternedKey.
+ */
+SymbolTable& global_symbols()
+{
+  static SymbolTable table;
+  return table;
+}
+
+/**
+ * @brief CustomKey with the name interned in global_symbols().
+ *
+ * Same order as CustomKey (by id, then alphabetically by name), but the
+ * name comparison is a comparison of two cached ranks.
+ */
+class InternedKey
+{
+public:
+  int      id;
+  uint32_t symbol;
+
+  InternedKey(int key_id, string_view key_name) : id(key_id), symbol(global_symbols().intern(key_name))
+  {
+  }
+
+  /**
+   * @brief Builds the key of an already interned name, for lookups.
+   *
+   * @return optional<InternedKey> Empty if the name was never interned, in
+   * which case no map can contain the key.
+   */
+  static optional<InternedKey> existing(int id, string_view name)
+  {
+    auto found = global_symbols().lookup(name);
+    if (!found) {
+      return nullopt;
+    }
+    return InternedKey(id, *found);
+  }
+
+  string_view name() const
+  {
+    return global_symbols().name(symbol);
+  }
+
+  bool operator<(const InternedKey& other) const
+  {
+    if (id == other.id) {
+      return global_symbols().rank(symbol) < global_symbols().rank(other.symbol);
+    }
+    return id < other.id;
+  }
+
+  bool operator==(const InternedKey& other) const
+  {
+    return id == other.id && symbol == other.symbol;
+  }
+
+private:
+  InternedKey(int key_id, uint32_t key_symbol) : id(key_id), symbol(key_symbol)
+  {
+  }
+};
+
+/**
+ * @brief Prints the entries of the map, in the same format as print_map() in
+ * maps.cpp.
+ */
+void print_map(const map<InternedKey, CustomValue>& m)
+{
+  for (const auto& [key, value] : m) {
+    cout << "Name: " << key.name() << " ID(" << key.id << ") -> Age: " << value.age << ", Address: " << value.address << '\n';
+  }
+}
+
+/**
+ * @brief Same operations as the menu of maps.cpp, on a map with interned keys.
+ */
+void basic_interning()
+{
+  map<InternedKey, CustomValue> m;
+  // Predefine, plus two keys that share an id and so are ordered by name
+  m[InternedKey(1, "Alice")]   = CustomValue(25, "123 Main St");
+  m[InternedKey(2, "Bob")]     = CustomValue(30, "456 Elm St");
+  m[InternedKey(3, "Charlie")] = CustomValue(35, "789 Oak St");
+  m[InternedKey(2, "Bea")]     = CustomValue(28, "10 Ash St");
+  print_map(m);
+
+  auto key = InternedKey::existing(2, "Bob");
+  if (key && m.count(*key) != 0) {
+    cout << "Found ID: 2 Name: Bob -> Age: " << m[*key].age << '\n';
+  }
+  cout << "\"Zoe\" is " << (InternedKey::existing(9, "Zoe") ? "" : "not ") << "interned" << '\n';
+  cout << global_symbols().size() << " symbols, " << global_symbols().string_bytes() << " bytes of names" << '\n';
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Builds and queries a map with CustomKey and one with InternedKey.
+ * Many entries share each id, so most comparisons reach the names.
+ *
+ * @param n        Number of entries.
+ * @param distinct Number of distinct names.
+ * @return bool True if both maps hold the same entries in the same order.
+ */
+bool benchmark(size_t n, size_t distinct)
+{
+  mt19937        rng(42);
+  vector<string> names;
+  for (size_t i = 0; i < distinct; ++i) {
+    names.push_back("customer-account-" + to_string(rng() % 1000000) + "-" + to_string(i));
+  }
+  vector<pair<int, size_t>> entries; // (id, index of the name)
+  for (size_t i = 0; i < n; ++i) {
+    entries.emplace_back(static_cast<int>(rng() % (n / 100 + 1)), rng() % distinct);
+  }
+
+  cout << "\nBenchmark with " << n << " entries, " << distinct << " distinct names" << '\n';
+
+  map<CustomKey, CustomValue>   plain;
+  map<InternedKey, CustomValue> interned;
+  cout << "insert  CustomKey: " << time_ms([&] {
+    for (const auto& e : entries) {
+      plain.emplace(CustomKey(e.first, names[e.second]), CustomValue(e.first % 100, ""));
+    }
+  }) << " ms, InternedKey: " << time_ms([&] {
+    for (const auto& e : entries) {
+      interned.emplace(InternedKey(e.first, names[e.second]), CustomValue(e.first % 100, ""));
+    }
+  }) << " ms\n";
+
+  long long plain_sum = 0, interned_sum = 0;
+  cout << "lookup  CustomKey: " << time_ms([&] {
+    for (const auto& e : entries) {
+      plain_sum += plain.find(CustomKey(e.first, names[e.second]))->second.age;
+    }
+  }) << " ms, InternedKey: " << time_ms([&] {
+    for (const auto& e : entries) {
+      interned_sum += interned.find(*InternedKey::existing(e.first, names[e.second]))->second.age;
+    }
+  }) << " ms\n";
+
+  // Keys built once, as a program holding keys would have them
+  vector<CustomKey>   plain_keys;
+  vector<InternedKey> interned_keys;
+  for (const auto& e : entries) {
+    plain_keys.emplace_back(e.first, names[e.second]);
+    interned_keys.emplace_back(e.first, names[e.second]);
+  }
+  cout << "find    CustomKey: " << time_ms([&] {
+    for (const auto& key : plain_keys) {
+      plain_sum += plain.find(key)->second.age;
+    }
+  }) << " ms, InternedKey: " << time_ms([&] {
+    for (const auto& key : interned_keys) {
+      interned_sum += interned.find(key)->second.age;
+    }
+  }) << " ms\n";
+
+  size_t name_bytes = 0;
+  for (const auto& entry : plain) {
+    name_bytes += entry.first.name.capacity() > 15 ? entry.first.name.capacity() + 1 : 0; // Heap part of each string
+  }
+  cout << "name storage  CustomKey: " << (plain.size() * sizeof(string) + name_bytes) / 1024 << " KiB, InternedKey: "
+       << (interned.size() * sizeof(uint32_t) + global_symbols().string_bytes()) / 1024 << " KiB (plus the symbol index)\n";
+
+  bool same = plain.size() == interned.size() && plain_sum == interned_sum;
+  auto it   = interned.begin();
+  for (const auto& entry : plain) {
+    same = same && entry.first.id == it->first.id && entry.first.name == it->first.name();
+    ++it;
+  }
+  return same;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of entries and of distinct names can be passed as the first and
+ * second arguments.
+ *
+ * @return int Returns 0 if both maps hold the same entries in the same order.
+ */
+int main(int argc, char* argv[])
+{
+  basic_interning();
+
+  size_t n        = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+  size_t distinct = argc > 2 ? strtoull(argv[2], nullptr, 10) : 1000;
+  bool   ok       = benchmark(n, max<size_t>(1, distinct));
+  cout << "Same results: " << (ok ? "yes" : "no") << '\n';
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,519 @@
+/**
+ * @file string_pool.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Contiguous string storage as an alternative to std::vector<string>.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * A std::vector<string> keeps a 32 byte string object per element, plus a
+ * separate heap allocation for every string longer than the small string
+ * buffer. StringPool packs the characters of all its strings into a single
+ * growing buffer and only keeps an (offset, length) span per element, handing
+ * out std::string_view objects to read them.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Sequence of strings whose characters live in one contiguous buffer.
+ *
+ * Elements are read as string_view. Any operation that adds characters may
+ * reallocate the buffer, which invalidates the views handed out before it.
+ * Sorting and erasing only reorder or drop spans; the bytes they leave unused
+ * are reclaimed by compact(). Views into a pool must not be passed back to
+ * the same pool's push_back() or assign(); copy them to a string first.
+ */
+class StringPool
+{
+public:
+  /**
+   * @brief Random access iterator that yields string_view by value.
+   */
+  class const_iterator
+  {
+  public:
+    using iterator_category = random_access_iterator_tag;
+    using value_type        = string_view;
+    using difference_type   = ptrdiff_t;
+    using pointer           = void;
+    using reference         = string_view;
+
+    const_iterator() = default;
+    const_iterator(const StringPool* pool, size_t index) : pool_(pool), index_(index)
+    {
+    }
+
+    string_view operator*() const
+    {
+      return (*pool_)[index_];
+    }
+    string_view operator[](difference_type n) const
+    {
+      return (*pool_)[index_ + static_cast<size_t>(n)];
+    }
+
+    const_iterator& operator++()
+    {
+      ++index_;
+      return *this;
+    }
+    const_iterator operator++(int)
+    {
+      const_iterator old = *this;
+      ++index_;
+      return old;
+    }
+    const_iterator& operator--()
+    {
+      --index_;
+      return *this;
+    }
+    const_iterator operator--(int)
+    {
+      const_iterator old = *this;
+      --index_;
+      return old;
+    }
+    const_iterator& operator+=(difference_type n)
+    {
+      index_ += static_cast<size_t>(n);
+      return *this;
+    }
+    const_iterator& operator-=(difference_type n)
+    {
+      index_ -= static_cast<size_t>(n);
+      return *this;
+    }
+    friend const_iterator operator+(const_iterator it, difference_type n)
+    {
+      return it += n;
+    }
+    friend const_iterator operator+(difference_type n, const_iterator it)
+    {
+      return it += n;
+    }
+    friend const_iterator operator-(const_iterator it, difference_type n)
+    {
+      return it -= n;
+    }
+    friend difference_type operator-(const const_iterator& a, const const_iterator& b)
+    {
+      return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+    }
+
+    friend bool operator==(const const_iterator& a, const const_iterator& b)
+    {
+      return a.index_ == b.index_;
+    }
+    friend bool operator!=(const const_iterator& a, const const_iterator& b)
+    {
+      return a.index_ != b.index_;
+    }
+    friend bool operator<(const const_iterator& a, const const_iterator& b)
+    {
+      return a.index_ < b.index_;
+    }
+    friend bool operator>(const const_iterator& a, const const_iterator& b)
+    {
+      return a.index_ > b.index_;
+    }
+    friend bool operator<=(const const_iterator& a, const const_iterator& b)
+    {
+      return a.index_ <= b.index_;
+    }
+    friend bool operator>=(const const_iterator& a, const const_iterator& b)
+    {
+      return a.index_ >= b.index_;
+    }
+
+  private:
+    const StringPool* pool_  = nullptr;
+    size_t            index_ = 0;
+  };
+
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  StringPool() = default;
+
+  StringPool(initializer_list<string_view> strings)
+  {
+    append(strings.begin(), strings.end());
+  }
+
+  /**
+   * @brief Returns the number of strings in the pool.
+   */
+  size_t size() const
+  {
+    return spans_.size();
+  }
+
+  /**
+   * @brief Returns true if the pool holds no strings.
+   */
+  bool empty() const
+  {
+    return spans_.empty();
+  }
+
+  /**
+   * @brief Returns the string at the given position, without bounds checking.
+   */
+  string_view operator[](size_t index) const
+  {
+    const Span& span = spans_[index];
+    return string_view(chars_.data() + span.offset, span.length);
+  }
+
+  /**
+   * @brief Returns the string at the given position.
+   *
+   * @throws std::out_of_range if index is not smaller than size().
+   */
+  string_view at(size_t index) const
+  {
+    if (index >= spans_.size()) {
+      throw out_of_range("StringPool::at: index out of range");
+    }
+    return (*this)[index];
+  }
+
+  const_iterator begin() const
+  {
+    return const_iterator(this, 0);
+  }
+  const_iterator end() const
+  {
+    return const_iterator(this, spans_.size());
+  }
+  const_reverse_iterator rbegin() const
+  {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const
+  {
+    return const_reverse_iterator(begin());
+  }
+
+  /**
+   * @brief Reserves room for a number of strings and a number of characters.
+   */
+  void reserve(size_t num_strings, size_t num_chars)
+  {
+    spans_.reserve(num_strings);
+    chars_.reserve(num_chars);
+  }
+
+  /**
+   * @brief Appends a copy of str at the end of the pool.
+   */
+  void push_back(string_view str)
+  {
+    spans_.push_back({chars_.size(), str.size()});
+    chars_.insert(chars_.end(), str.begin(), str.end());
+  }
+
+  /**
+   * @brief Appends every string of [first, last) at the end of the pool.
+   *
+   * When the range can be traversed twice, both buffers are grown once to
+   * their final size before copying.
+   *
+   * @param first Iterator to the first string; anything convertible to string_view.
+   * @param last  End of the range.
+   */
+  template <typename It>
+  void append(It first, It last)
+  {
+    using category = typename iterator_traits<It>::iterator_category;
+    if constexpr (is_base_of<forward_iterator_tag, category>::value) {
+      size_t num_chars = 0;
+      for (It it = first; it != last; ++it) {
+        num_chars += string_view(*it).size();
+      }
+      reserve(spans_.size() + static_cast<size_t>(distance(first, last)), chars_.size() + num_chars);
+    }
+    for (; first != last; ++first) {
+      push_back(string_view(*first));
+    }
+  }
+
+  /**
+   * @brief Replaces the string at the given position.
+   *
+   * The new characters are written in place when they fit, otherwise they are
+   * appended at the end of the buffer and the old bytes become garbage.
+   */
+  void assign(size_t index, string_view str)
+  {
+    Span& span = spans_.at(index);
+    if (str.size() <= span.length) {
+      copy(str.begin(), str.end(), chars_.begin() + static_cast<ptrdiff_t>(span.offset));
+      garbage_ += span.length - str.size();
+      span.length = str.size();
+      return;
+    }
+    garbage_ += span.length;
+    span = {chars_.size(), str.size()};
+    chars_.insert(chars_.end(), str.begin(), str.end());
+  }
+
+  /**
+   * @brief Removes the string at the given position. Its bytes become garbage.
+   */
+  void erase(size_t index)
+  {
+    garbage_ += spans_.at(index).length;
+    spans_.erase(spans_.begin() + static_cast<ptrdiff_t>(index));
+  }
+
+  /**
+   * @brief Removes every string for which pred returns true, in one pass.
+   *
+   * @return size_t The number of strings removed.
+   */
+  template <typename Predicate>
+  size_t erase_if(Predicate pred)
+  {
+    size_t old_size = spans_.size();
+    auto   new_end  = remove_if(spans_.begin(), spans_.end(), [&](const Span& span) {
+      if (pred(string_view(chars_.data() + span.offset, span.length))) {
+        garbage_ += span.length;
+        return true;
+      }
+      return false;
+    });
+    spans_.erase(new_end, spans_.end());
+    return old_size - spans_.size();
+  }
+
+  /**
+   * @brief Sorts the strings by comparing their views.
+   *
+   * Only the 16 byte spans move, the characters stay where they are. Call
+   * compact() afterwards to lay the characters out in the new order.
+   *
+   * @param comp Strict weak ordering over string_view.
+   */
+  template <typename Compare = less<string_view>>
+  void sort(Compare comp = Compare())
+  {
+    const char* base = chars_.data();
+    std::sort(spans_.begin(), spans_.end(), [&](const Span& a, const Span& b) {
+      return comp(string_view(base + a.offset, a.length), string_view(base + b.offset, b.length));
+    });
+  }
+
+  /**
+   * @brief Rewrites the character buffer in element order, dropping the bytes
+   * left behind by erase() and assign() and releasing spare capacity.
+   */
+  void compact()
+  {
+    vector<char> packed;
+    packed.reserve(chars_.size() - garbage_);
+    for (Span& span : spans_) {
+      size_t offset = packed.size();
+      packed.insert(packed.end(), chars_.begin() + static_cast<ptrdiff_t>(span.offset),
+                    chars_.begin() + static_cast<ptrdiff_t>(span.offset + span.length));
+      span.offset = offset;
+    }
+    chars_.swap(packed);
+    spans_.shrink_to_fit();
+    garbage_ = 0;
+  }
+
+  /**
+   * @brief Removes every string and keeps the allocated buffers.
+   */
+  void clear()
+  {
+    spans_.clear();
+    chars_.clear();
+    garbage_ = 0;
+  }
+
+  /**
+   * @brief Returns the number of bytes in the character buffer no element refers to.
+   */
+  size_t garbage_bytes() const
+  {
+    return garbage_;
+  }
+
+  /**
+   * @brief Returns the heap memory held by the pool, in bytes.
+   */
+  size_t memory_usage() const
+  {
+    return spans_.capacity() * sizeof(Span) + chars_.capacity();
+  }
+
+private:
+  /**
+   * @brief Location of one string inside the character buffer.
+   */
+  struct Span
+  {
+    size_t offset;
+    size_t length;
+  };
+
+  vector<char> chars_;
+  vector<Span> spans_;
+  size_t       garbage_ = 0;
+};
+
+/**
+ * @brief Prints the strings of a pool separated by spaces.
+ */
+void print_pool(const StringPool& pool)
+{
+  cout << '\n';
+  for (string_view str : pool) {
+    cout << str << ' ';
+  }
+  cout << '\n';
+}
+
+/**
+ * @brief Same walkthrough as basic_vector_init() in vectors.cpp, on a StringPool.
+ */
+void basic_pool_init()
+{
+  StringPool strings;
+
+  strings.push_back("one");
+  strings.push_back("two");
+  strings.push_back("three");
+
+  cout << "Size of strings: " << strings.size() << '\n';
+  cout << "Memory of strings: " << strings.memory_usage() << " bytes\n";
+
+  cout << "\nIteration over strings using range-based for loop:" << '\n';
+  for (string_view str : strings) {
+    cout << str << '\n';
+  }
+
+  cout << "\nIteration over strings using reverse iterator:" << '\n';
+  for (auto it = strings.rbegin(); it != strings.rend(); ++it) {
+    cout << *it << '\n';
+  }
+
+  cout << "\nSort, replace \"two\" and erase \"one\":";
+  strings.sort();
+  strings.assign(2, "TWO");
+  strings.erase(0);
+  print_pool(strings);
+  cout << "Garbage bytes before compact: " << strings.garbage_bytes() << '\n';
+  strings.compact();
+  cout << "Garbage bytes after compact: " << strings.garbage_bytes() << '\n';
+}
+
+/**
+ * @brief Estimates the heap memory held by a vector of strings, in bytes.
+ *
+ * Strings that fit in the small string buffer do not allocate; longer ones
+ * allocate capacity() + 1 bytes.
+ */
+size_t memory_usage(const vector<string>& strings)
+{
+  size_t bytes = strings.capacity() * sizeof(string);
+  for (const auto& str : strings) {
+    if (str.capacity() > string().capacity()) {
+      bytes += str.capacity() + 1;
+    }
+  }
+  return bytes;
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Compares building, sorting and scanning a vector<string> and a
+ * StringPool with the same contents.
+ *
+ * @param n Number of random strings, 8 to 40 characters long.
+ * @return bool True if both hold the same strings in the same order.
+ */
+bool benchmark(size_t n)
+{
+  mt19937                       rng(7);
+  uniform_int_distribution<int> length(8, 40);
+  uniform_int_distribution<int> letter('a', 'z');
+  vector<string>                source(n);
+  for (auto& str : source) {
+    str.resize(static_cast<size_t>(length(rng)));
+    for (auto& c : str) {
+      c = static_cast<char>(letter(rng));
+    }
+  }
+
+  vector<string> strings;
+  StringPool     pool;
+  cout << "\nBenchmark with " << n << " strings" << '\n';
+  cout << "Build vector<string>: " << time_ms([&] { strings.assign(source.begin(), source.end()); }) << " ms\n";
+  cout << "Build StringPool:     " << time_ms([&] { pool.append(source.begin(), source.end()); }) << " ms\n";
+
+  cout << "Sort vector<string>:  " << time_ms([&] { sort(strings.begin(), strings.end()); }) << " ms\n";
+  cout << "Sort StringPool:      " << time_ms([&] { pool.sort(); }) << " ms\n";
+  cout << "Compact StringPool:   " << time_ms([&] { pool.compact(); }) << " ms\n";
+
+  size_t total = 0;
+  cout << "Scan vector<string>:  " << time_ms([&] {
+    for (const auto& str : strings) {
+      total += str.size();
+    }
+  }) << " ms\n";
+  cout << "Scan StringPool:      " << time_ms([&] {
+    for (string_view str : pool) {
+      total -= str.size();
+    }
+  }) << " ms\n";
+
+  cout << "Memory vector<string>: " << memory_usage(strings) << " bytes\n";
+  cout << "Memory StringPool:     " << pool.memory_usage() << " bytes\n";
+  bool same = total == 0 && equal(strings.begin(), strings.end(), pool.begin(), pool.end());
+  cout << "Same contents: " << (same ? "yes" : "no") << '\n';
+  return same;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * Shows the basic StringPool operations and then benchmarks it against a
+ * vector<string>. The number of strings can be passed as the first argument.
+ *
+ * @return int Returns 0 if the vector and the pool ended with the same
+ * contents.
+ */
+int main(int argc, char* argv[])
+{
+  basic_pool_init();
+  bool ok = benchmark(argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000);
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,761 @@
+/**
+ * @file swiss_map.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Open addressing hash map with SIMD group probing ("Swiss table")
+ * for CustomKey to CustomValue.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * A lookup in map<CustomKey, CustomValue> walks about log2(n) tree nodes,
+ * each one a cache miss. std::unordered_map jumps to a bucket, but then
+ * follows a pointer to a separately allocated node. SwissMap stores the
+ * entries inline in one array and keeps a parallel array of control bytes,
+ * one per slot: 0x80 for an empty slot, or 7 bits of the hash of the key in
+ * it. A lookup compares 16 control bytes at once with SSE2 instructions and
+ * only looks at the entries whose 7 bits match, which is nearly always just
+ * the one it is looking for.
+ *
+ * The probe sequence is linear, so an erased entry does not leave a
+ * tombstone: the following entries of its cluster are shifted back instead
+ * (backward shift deletion), and lookups never slow down after many erases.
+ *
+ * Without SSE2 a portable loop over the 16 bytes is used.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "custom_types.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SWISS_MAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+/**
+ * @brief Bit masks over a group of 16 control bytes.
+ */
+class ControlGroup
+{
+public:
+  static constexpr size_t width = 16;
+
+  explicit ControlGroup(const uint8_t* ctrl)
+  {
+#ifdef SWISS_MAP_SSE2
+    bytes_ = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#else
+    memcpy(bytes_, ctrl, width);
+#endif
+  }
+
+  /**
+   * @brief Bit i is set if byte i equals h2.
+   */
+  uint32_t match(uint8_t h2) const
+  {
+#ifdef SWISS_MAP_SSE2
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes_, _mm_set1_epi8(static_cast<char>(h2)))));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < width; ++i) {
+      mask |= uint32_t(bytes_[i] == h2) << i;
+    }
+    return mask;
+#endif
+  }
+
+  /**
+   * @brief Bit i is set if slot i is empty (its byte has the high bit set).
+   */
+  uint32_t match_empty() const
+  {
+#ifdef SWISS_MAP_SSE2
+    return static_cast<uint32_t>(_mm_movemask_epi8(bytes_));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < width; ++i) {
+      mask |= uint32_t(bytes_[i] >> 7) << i;
+    }
+    return mask;
+#endif
+  }
+
+private:
+#ifdef SWISS_MAP_SSE2
+  __m128i bytes_;
+#else
+  uint8_t bytes_[width];
+#endif
+};
+
+/**
+ * @brief Index of the lowest set bit of a non-zero mask.
+ */
+inline unsigned lowest_bit(uint32_t mask)
+{
+  unsigned i = 0;
+  while ((mask & 1) == 0) {
+    mask >>= 1;
+    ++i;
+  }
+  return i;
+}
+
+/**
+ * @brief Open addressing hash map with 16-wide control byte groups.
+ *
+ * The capacity is a power of two of at least 16 slots, and the map grows
+ * when it is 7/8 full. Iterators dereference to a pair<const Key&, Value&>
+ * (by value, like a proxy). Insertions and erasures invalidate iterators.
+ *
+ * @tparam Key   Key type.
+ * @tparam Value Mapped type.
+ * @tparam Hash  Hash of the keys. With Eq, accepts other key types if both
+ *               define is_transparent.
+ * @tparam Eq    Equality of the keys.
+ */
+template <typename Key, typename Value, typename Hash = hash<Key>, typename Eq = equal_to<Key>>
+class SwissMap
+{
+  static constexpr uint8_t empty_byte = 0x80;
+  static constexpr size_t  width      = ControlGroup::width;
+
+  struct Entry
+  {
+    Key   key;
+    Value value;
+  };
+
+  // Lookups take any key type when hash and equality are transparent, and only Key otherwise
+  template <typename K, typename H = Hash, typename E = Eq, typename = typename H::is_transparent, typename = typename E::is_transparent>
+  static const K& lookup_key(const K& key, int)
+  {
+    return key;
+  }
+  template <typename K>
+  static const Key& lookup_key(const Key& key, long)
+  {
+    return key;
+  }
+
+public:
+  template <bool Const>
+  class basic_iterator
+  {
+    using Map = conditional_t<Const, const SwissMap, SwissMap>;
+
+  public:
+    using iterator_category = forward_iterator_tag;
+    using value_type        = pair<Key, Value>;
+    using difference_type   = ptrdiff_t;
+    using reference         = pair<const Key&, conditional_t<Const, const Value&, Value&>>;
+
+    struct pointer
+    {
+      reference ref;
+      reference* operator->()
+      {
+        return &ref;
+      }
+    };
+
+    basic_iterator() = default;
+    basic_iterator(Map* map, size_t index) : map_(map), index_(index)
+    {
+      skip_empty();
+    }
+    // An iterator converts to a const_iterator, not the other way around.
+    template <bool OtherConst, typename = enable_if_t<Const && !OtherConst>>
+    basic_iterator(const basic_iterator<OtherConst>& other) : map_(other.map_), index_(other.index_)
+    {
+    }
+
+    reference operator*() const
+    {
+      auto& entry = map_->slots_[index_];
+      return {entry.key, entry.value};
+    }
+    pointer operator->() const
+    {
+      return pointer{**this};
+    }
+
+    basic_iterator& operator++()
+    {
+      ++index_;
+      skip_empty();
+      return *this;
+    }
+    basic_iterator operator++(int)
+    {
+      basic_iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    friend bool operator==(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ == b.index_;
+    }
+    friend bool operator!=(const basic_iterator& a, const basic_iterator& b)
+    {
+      return a.index_ != b.index_;
+    }
+
+  private:
+    friend class SwissMap;
+    template <bool>
+    friend class basic_iterator;
+
+    void skip_empty()
+    {
+      while (index_ < map_->capacity_ && map_->ctrl_[index_] == empty_byte) {
+        ++index_;
+      }
+    }
+
+    Map*   map_   = nullptr;
+    size_t index_ = 0;
+  };
+
+  using iterator       = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+
+  SwissMap() = default;
+
+  SwissMap(const SwissMap& other)
+  {
+    reserve(other.size());
+    for (auto entry : other) {
+      insert(entry.first, entry.second);
+    }
+  }
+
+  SwissMap(SwissMap&& other) noexcept
+  {
+    swap_with(other);
+  }
+
+  SwissMap& operator=(SwissMap other) noexcept
+  {
+    swap_with(other);
+    return *this;
+  }
+
+  ~SwissMap()
+  {
+    destroy_all();
+  }
+
+  iterator begin()
+  {
+    return iterator(this, 0);
+  }
+  iterator end()
+  {
+    return iterator(this, capacity_);
+  }
+  const_iterator begin() const
+  {
+    return const_iterator(this, 0);
+  }
+  const_iterator end() const
+  {
+    return const_iterator(this, capacity_);
+  }
+
+  size_t size() const
+  {
+    return size_;
+  }
+
+  bool empty() const
+  {
+    return size_ == 0;
+  }
+
+  size_t capacity() const
+  {
+    return capacity_;
+  }
+
+  double load_factor() const
+  {
+    return capacity_ == 0 ? 0.0 : static_cast<double>(size_) / static_cast<double>(capacity_);
+  }
+
+  template <typename K>
+  iterator find(const K& key)
+  {
+    return iterator(this, find_slot(lookup_key<K>(key, 0)));
+  }
+
+  template <typename K>
+  const_iterator find(const K& key) const
+  {
+    return const_iterator(this, find_slot(lookup_key<K>(key, 0)));
+  }
+
+  template <typename K>
+  bool contains(const K& key) const
+  {
+    return find_slot(lookup_key<K>(key, 0)) != capacity_;
+  }
+
+  /**
+   * @throws std::out_of_range if the key is not in the map.
+   */
+  template <typename K>
+  Value& at(const K& key)
+  {
+    size_t slot = find_slot(lookup_key<K>(key, 0));
+    if (slot == capacity_) {
+      throw out_of_range("SwissMap::at: key not found");
+    }
+    return slots_[slot].value;
+  }
+
+  Value& operator[](const Key& key)
+  {
+    size_t slot = insert(key, Value()).first.index_;
+    return slots_[slot].value;
+  }
+
+  /**
+   * @brief Inserts key with value if the key is not in the map yet.
+   *
+   * @return pair<iterator, bool> The entry of the key, and whether it was inserted.
+   */
+  pair<iterator, bool> insert(Key key, Value value)
+  {
+    return insert_or_update(move(key), move(value), false);
+  }
+
+  /**
+   * @brief Inserts key with value, or assigns value to the entry of key if
+   * it is already in the map.
+   *
+   * @return pair<iterator, bool> The entry of the key, and whether it was inserted.
+   */
+  pair<iterator, bool> insert_or_assign(Key key, Value value)
+  {
+    return insert_or_update(move(key), move(value), true);
+  }
+
+  /**
+   * @brief Removes the entry of key, if any, and shifts the rest of its
+   * cluster back so no tombstone is left.
+   *
+   * @return size_t The number of entries removed (0 or 1).
+   */
+  template <typename K>
+  size_t erase(const K& key)
+  {
+    size_t slot = find_slot(lookup_key<K>(key, 0));
+    if (slot == capacity_) {
+      return 0;
+    }
+    erase_slot(slot);
+    return 1;
+  }
+
+  /**
+   * @brief Removes the entry at pos. Entries that followed it may move, so
+   * no iterator stays valid.
+   */
+  void erase(const_iterator pos)
+  {
+    erase_slot(pos.index_);
+  }
+
+  // Without it, erase(find(key)) would pick the key template above, which
+  // matches an iterator exactly
+  void erase(iterator pos)
+  {
+    erase_slot(pos.index_);
+  }
+
+  /**
+   * @brief Makes room for count entries without growing again.
+   */
+  void reserve(size_t count)
+  {
+    size_t needed = width;
+    while (needed - needed / 8 < count) {
+      needed *= 2;
+    }
+    if (needed > capacity_) {
+      rehash(needed);
+    }
+  }
+
+  /**
+   * @brief Rebuilds the table with at least count slots (rounded up to a
+   * power of two, and to what the current entries need).
+   */
+  void rehash(size_t count)
+  {
+    size_t new_capacity = width;
+    while (new_capacity < count || new_capacity - new_capacity / 8 < size_) {
+      new_capacity *= 2;
+    }
+
+    unique_ptr<uint8_t[]> old_ctrl     = move(ctrl_);
+    Entry*                old_slots    = slots_;
+    size_t                old_capacity = capacity_;
+
+    allocate(new_capacity);
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (old_ctrl[i] != empty_byte) {
+        Entry& entry = old_slots[i];
+        size_t hash  = hasher_(entry.key);
+        place(probe_for(entry.key, hash).first, hash, move(entry.key), move(entry.value));
+        entry.~Entry();
+      }
+    }
+    ::operator delete(old_slots, align_val_t(alignof(Entry)));
+  }
+
+  void clear()
+  {
+    destroy_all();
+    ctrl_.reset();
+    slots_    = nullptr;
+    capacity_ = 0;
+    size_     = 0;
+  }
+
+private:
+  size_t max_load() const
+  {
+    return capacity_ - capacity_ / 8;
+  }
+
+  static uint8_t h2(size_t hash)
+  {
+    return static_cast<uint8_t>(hash & 0x7F);
+  }
+
+  size_t home(size_t hash) const
+  {
+    return (hash >> 7) & (capacity_ - 1);
+  }
+
+  /**
+   * @brief Probes from the home slot of key, 16 slots at a time.
+   *
+   * @return pair<size_t, bool> The slot of key and true if it is in the map;
+   * otherwise the first empty slot of its probe sequence and false.
+   */
+  template <typename K>
+  pair<size_t, bool> probe_for(const K& key, size_t hash) const
+  {
+    uint8_t tag = h2(hash);
+    for (size_t pos = home(hash);; pos = (pos + width) & (capacity_ - 1)) {
+      ControlGroup group(ctrl_.get() + pos);
+      for (uint32_t mask = group.match(tag); mask != 0; mask &= mask - 1) {
+        size_t slot = (pos + lowest_bit(mask)) & (capacity_ - 1);
+        if (equal_(slots_[slot].key, key)) {
+          return {slot, true};
+        }
+      }
+      uint32_t empties = group.match_empty();
+      if (empties != 0) {
+        return {(pos + lowest_bit(empties)) & (capacity_ - 1), false};
+      }
+    }
+  }
+
+  /**
+   * @brief Shared body of insert and insert_or_assign: one probe, then the
+   * value is moved either into a new entry or, if assign is true, over the
+   * value of the existing one.
+   */
+  pair<iterator, bool> insert_or_update(Key&& key, Value&& value, bool assign)
+  {
+    size_t hash = hasher_(key);
+    if (capacity_ != 0) {
+      auto probe = probe_for(key, hash);
+      if (probe.second) {
+        if (assign) {
+          slots_[probe.first].value = move(value);
+        }
+        return {iterator(this, probe.first), false};
+      }
+      if (size_ + 1 <= max_load()) {
+        place(probe.first, hash, move(key), move(value));
+        return {iterator(this, probe.first), true};
+      }
+    }
+    rehash(capacity_ == 0 ? width : 2 * capacity_);
+    size_t slot = probe_for(key, hash).first;
+    place(slot, hash, move(key), move(value));
+    return {iterator(this, slot), true};
+  }
+
+  template <typename K>
+  size_t find_slot(const K& key) const
+  {
+    if (size_ == 0) {
+      return capacity_;
+    }
+    auto probe = probe_for(key, hasher_(key));
+    return probe.second ? probe.first : capacity_;
+  }
+
+  /**
+   * @brief Sets the control byte of a slot, and its copy past the end that
+   * lets a group load starting near the end wrap around.
+   */
+  void set_ctrl(size_t slot, uint8_t value)
+  {
+    ctrl_[slot] = value;
+    if (slot < width - 1) {
+      ctrl_[capacity_ + slot] = value;
+    }
+  }
+
+  void place(size_t slot, size_t hash, Key&& key, Value&& value)
+  {
+    new (&slots_[slot]) Entry{move(key), move(value)};
+    set_ctrl(slot, h2(hash));
+    ++size_;
+  }
+
+  /**
+   * @brief Backward shift deletion: every following entry of the cluster
+   * whose home slot is not between the hole and itself moves into the hole.
+   */
+  void erase_slot(size_t hole)
+  {
+    size_t mask = capacity_ - 1;
+    slots_[hole].~Entry();
+    for (size_t next = (hole + 1) & mask; ctrl_[next] != empty_byte; next = (next + 1) & mask) {
+      size_t h = home(hasher_(slots_[next].key));
+      // The entry can stay if its home is cyclically in (hole, next]
+      bool stays = hole <= next ? (hole < h && h <= next) : (hole < h || h <= next);
+      if (!stays) {
+        new (&slots_[hole]) Entry{move(slots_[next].key), move(slots_[next].value)};
+        slots_[next].~Entry();
+        set_ctrl(hole, ctrl_[next]);
+        hole = next;
+      }
+    }
+    set_ctrl(hole, empty_byte);
+    --size_;
+  }
+
+  void allocate(size_t new_capacity)
+  {
+    ctrl_.reset(new uint8_t[new_capacity + width - 1]);
+    fill(ctrl_.get(), ctrl_.get() + new_capacity + width - 1, empty_byte);
+    slots_    = static_cast<Entry*>(::operator new(new_capacity * sizeof(Entry), align_val_t(alignof(Entry))));
+    capacity_ = new_capacity;
+    size_     = 0;
+  }
+
+  void destroy_all()
+  {
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (ctrl_[i] != empty_byte) {
+        slots_[i].~Entry();
+      }
+    }
+    if (slots_ != nullptr) {
+      ::operator delete(slots_, align_val_t(alignof(Entry)));
+    }
+  }
+
+  void swap_with(SwissMap& other) noexcept
+  {
+    swap(ctrl_, other.ctrl_);
+    swap(slots_, other.slots_);
+    swap(capacity_, other.capacity_);
+    swap(size_, other.size_);
+  }
+
+  unique_ptr<uint8_t[]> ctrl_;
+  Entry*                slots_    = nullptr;
+  size_t                capacity_ = 0;
+  size_t                size_     = 0;
+  Hash                  hasher_;
+  Eq                    equal_;
+};
+
+using CustomSwissMap = SwissMap<CustomKey, CustomValue, CustomKeyHash, CustomKeyEqual>;
+
+/**
+ * @brief Prints the entries of the map, in the same format as print_map() in
+ * maps.cpp. The order is the order of the slots.
+ */
+void print_map(const CustomSwissMap& m)
+{
+  for (const auto& [key, value] : m) {
+    cout << "Name: " << key.name << " ID(" << key.id << ") -> Age: " << value.age << ", Address: " << value.address << '\n';
+  }
+}
+
+/**
+ * @brief Same operations as the menu of maps.cpp, on a CustomSwissMap.
+ */
+void basic_swiss_map()
+{
+  CustomSwissMap m;
+  // Predefine
+  m[CustomKey(1, "Alice")]   = CustomValue(25, "123 Main St");
+  m[CustomKey(2, "Bob")]     = CustomValue(30, "456 Elm St");
+  m[CustomKey(3, "Charlie")] = CustomValue(35, "789 Oak St");
+  print_map(m);
+
+  // Modify and remove, looking keys up without building a CustomKey
+  m.at(CustomKeyView{2, "Bob"}).age = 31;
+  m.erase(CustomKeyView{1, "Alice"});
+  print_map(m);
+
+  // Find
+  auto it = m.find(CustomKeyView{3, "Charlie"});
+  if (it != m.end()) {
+    cout << "Found ID: " << it->first.id << " Name: " << it->first.name << " -> Age: " << it->second.age << ", Address: " << it->second.address << '\n';
+  }
+  cout << "The size of the map is: " << m.size() << '\n';
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Runs the same insert, lookup and erase mix on std::map,
+ * std::unordered_map and SwissMap.
+ *
+ * @param n Number of keys.
+ * @return bool True if the three maps agree on every lookup.
+ */
+bool benchmark(size_t n)
+{
+  mt19937           rng(41);
+  vector<CustomKey> keys;
+  for (size_t i = 0; i < n; ++i) {
+    int id = static_cast<int>(rng());
+    keys.emplace_back(id, "user" + to_string(id % 100000));
+  }
+  vector<size_t> queries(n);
+  for (auto& q : queries) {
+    q = rng() % n;
+  }
+
+  map<CustomKey, CustomValue>                                         tree;
+  unordered_map<CustomKey, CustomValue, CustomKeyHash, CustomKeyEqual> hashed;
+  CustomSwissMap                                                      swiss;
+  long long                                                           sums[3] = {0, 0, 0};
+
+  cout << "\nBenchmark with " << n << " keys (times in ms: map, unordered_map, SwissMap)" << '\n';
+
+  auto insert_all = [&](auto& m) {
+    for (size_t i = 0; i < n; ++i) {
+      m.insert({keys[i], CustomValue(static_cast<int>(i % 100), "")});
+    }
+  };
+  cout << "insert:        " << time_ms([&] { insert_all(tree); }) << ", " << time_ms([&] { insert_all(hashed); }) << ", " << time_ms([&] {
+    for (size_t i = 0; i < n; ++i) {
+      swiss.insert(keys[i], CustomValue(static_cast<int>(i % 100), ""));
+    }
+  }) << '\n';
+
+  auto lookup_all = [&](auto& m, long long& sum) {
+    for (size_t q : queries) {
+      auto it = m.find(keys[q]);
+      sum += it != m.end() ? it->second.age : -1;
+    }
+  };
+  cout << "lookup (hits): " << time_ms([&] { lookup_all(tree, sums[0]); }) << ", " << time_ms([&] { lookup_all(hashed, sums[1]); }) << ", "
+       << time_ms([&] {
+            for (size_t q : queries) {
+              auto it = swiss.find(CustomKeyView{keys[q].id, keys[q].name});
+              sums[2] += it != swiss.end() ? it->second.age : -1;
+            }
+          })
+       << '\n';
+
+  // Keys that are not in the maps
+  vector<CustomKey> missing;
+  for (size_t i = 0; i < n; ++i) {
+    missing.emplace_back(static_cast<int>(rng()), "nobody");
+  }
+  auto miss_all = [&](auto& m, long long& sum) {
+    for (const auto& key : missing) {
+      sum += m.find(key) != m.end() ? 1 : 0;
+    }
+  };
+  cout << "lookup (miss): " << time_ms([&] { miss_all(tree, sums[0]); }) << ", " << time_ms([&] { miss_all(hashed, sums[1]); }) << ", "
+       << time_ms([&] { miss_all(swiss, sums[2]); }) << '\n';
+
+  // Erase half of the keys and insert them again, interleaved with lookups
+  auto churn = [&](auto& m, long long& sum) {
+    for (size_t i = 0; i < n; i += 2) {
+      m.erase(keys[i]);
+      auto it = m.find(keys[queries[i]]);
+      sum += it != m.end() ? it->second.age : -1;
+    }
+    for (size_t i = 0; i < n; i += 2) {
+      m.insert({keys[i], CustomValue(static_cast<int>(i % 100), "")});
+    }
+  };
+  cout << "erase/insert:  " << time_ms([&] { churn(tree, sums[0]); }) << ", " << time_ms([&] { churn(hashed, sums[1]); }) << ", " << time_ms([&] {
+    for (size_t i = 0; i < n; i += 2) {
+      swiss.erase(keys[i]);
+      auto it = swiss.find(keys[queries[i]]);
+      sums[2] += it != swiss.end() ? it->second.age : -1;
+    }
+    for (size_t i = 0; i < n; i += 2) {
+      swiss.insert(keys[i], CustomValue(static_cast<int>(i % 100), ""));
+    }
+  }) << '\n';
+
+  cout << "SwissMap load factor: " << swiss.load_factor() << '\n';
+  return sums[0] == sums[1] && sums[1] == sums[2] && tree.size() == hashed.size() && hashed.size() == swiss.size();
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of keys of the benchmark can be passed as the first argument.
+ *
+ * @return int Returns 0 if the three maps give the same results.
+ */
+int main(int argc, char* argv[])
+{
+  basic_swiss_map();
+
+  bool ok = benchmark(argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000);
+  cout << "Same results: " << (ok ? "yes" : "no") << '\n';
+
+  return ok ? 0 : 1;
+}
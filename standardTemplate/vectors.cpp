@@ -10,84 +10,33 @@
  * @copyright Copyright (c) 2025
  *
  */
+#include "allocation_tracker.h"
+#include "range_formatter.h"
 #include <iostream>
 #include <vector>
 
 using namespace std;
 
 /**
- * @brief Prints the elements of a vector of integers.
+ * @brief Prints the elements of a vector to the standard output.
  *
- * This function takes a constant reference to a vector of integers and prints
- * each element followed by a space. After printing all elements, it outputs a
- * newline character.
+ * Works for vectors of numbers, strings, pairs and nested vectors. Numbers and
+ * strings are printed on a single line, each followed by a space. Pairs are
+ * printed one per line as "first: second", and each inner vector of a 2D
+ * vector on its own line. The text is built in the shared console formatter
+ * and written to cout in one go.
  *
- * @param v The vector of integers to be printed.
+ * @param v A constant reference to the vector to be printed.
  */
-void print_vector(const vector<int>& v)
+template <typename T>
+void print_vector(const vector<T>& v)
 {
-  cout << '\n';
-  for (const auto& elem : v) {
-    cout << elem << ' ';
-  }
-  cout << '\n';
-}
-
-/**
- * @brief Prints the elements of a vector of strings to the standard output.
- *
- * This function takes a constant reference to a vector of strings and prints
- * each element followed by a space. After printing all elements, it outputs
- * a newline character.
- *
- * @param v A constant reference to a vector of strings to be printed.
- */
-void print_vector(const vector<string>& v)
-{
-  cout << '\n';
-  for (const auto& elem : v) {
-    cout << elem << ' ';
-  }
-  cout << '\n';
-}
-
-/**
- * @brief Prints the contents of a vector of pairs.
- *
- * This function takes a constant reference to a vector of pairs, where each
- * pair consists of an integer and a string. It iterates through the vector and
- * prints each pair's integer and string to the standard output.
- *
- * @param v A constant reference to a vector of pairs (int, string) to be
- * printed.
- */
-void print_vector(const vector<pair<int, string>>& v)
-{
-  cout << '\n';
-  for (const auto& elem : v) {
-    cout << elem.first << ": " << elem.second << '\n';
-  }
-}
-
-/**
- * @brief Prints a 2D vector of integers to the standard output.
- *
- * This function takes a constant reference to a 2D vector of integers and
- * prints its elements to the standard output. Each inner vector's elements
- * are printed on a single line, separated by spaces. Each inner vector is
- * printed on a new line.
- *
- * @param v A constant reference to a 2D vector of integers to be printed.
- */
-void print_vector(const vector<vector<int>>& v)
-{
-  cout << '\n';
-  for (const auto& elem : v) {
-    for (const auto& inner_elem : elem) {
-      cout << inner_elem << ' ';
-    }
-    cout << '\n';
+  RangeFormatter& out = console_formatter();
+  out.put('\n').write(v);
+  if ((!is_range<T>::value && !is_pair<T>::value) || is_string_like<T>::value) {
+    out.put('\n');
   }
+  out.flush();
 }
 
 /**
@@ -204,9 +153,12 @@ void basic_vector_init()
  * - Resizes the vector to 100 elements and displays its size and capacity.
  * - Reserves memory for 100000 elements and displays its size and capacity.
  * - Shrinks the vector to fit its size and displays its size and capacity.
+ *
+ * Build with -DTRACK_ALLOCATIONS to see how many heap allocations it makes.
  */
 void basic_vector_resize()
 {
+  ALLOCATION_SCOPE("basic_vector_resize");
   vector<int>            numbers;
   vector<int>::size_type capacity = numbers.capacity();
 
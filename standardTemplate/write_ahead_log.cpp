@@ -0,0 +1,1175 @@
+/**
+ * @file write_ahead_log.cpp
+ * @author Miguel Ferrer (mferrer@inbiot.es)
+ * @brief  Write-ahead log, checkpoints and crash recovery for the map of
+ * maps.cpp.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * The map of maps.cpp lives in memory and is lost when the program exits.
+ * DurableMap offers the same insert, modify, remove and clear operations and
+ * writes each one to a log file before changing the map. Each record is:
+ *
+ *   [u32 size of the rest][u32 CRC-32 of the rest][u64 sequence number][operation]
+ *
+ * with every number in little-endian order. The CRC-32 reads the operation
+ * first and the sequence number last, so most of it can be computed before
+ * the record gets its number. A record that is cut short or fails its CRC
+ * marks the end of the log: it is the write that a crash interrupted.
+ *
+ * Calling fsync after every record costs more than the change to the map
+ * itself. With group commit, a background thread writes and syncs all the
+ * records appended while the previous sync ran, so many operations share
+ * one fsync. Each operation still waits for its own record to be durable.
+ * In async mode, operations do not wait at all, the thread writes the
+ * records gathered every millisecond, and a crash can lose the records of
+ * the last few milliseconds.
+ *
+ * When the log outgrows a limit, DurableMap writes the whole map to a
+ * checkpoint file and empties the log. On start, it loads the checkpoint and
+ * replays the records after it, so recovery never reads more than one
+ * checkpoint and one log of that size.
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "custom_map.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/**
+ * @brief Unbuffered file access with the system calls of each platform, which
+ * unlike fstream can force the data to the disk.
+ */
+namespace file_io
+{
+#ifdef _WIN32
+inline int open_for_append(const string& path)
+{
+  return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+inline int open_for_write(const string& path)
+{
+  return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+inline bool sync(int fd)
+{
+  return _commit(fd) == 0;
+}
+inline bool resize(int fd, uint64_t size)
+{
+  return _chsize_s(fd, static_cast<__int64>(size)) == 0;
+}
+inline bool sync_parent_directory(const string&)
+{
+  return true; // MoveFileExA with MOVEFILE_WRITE_THROUGH already flushed the rename
+}
+inline void close_file(int fd)
+{
+  _close(fd);
+}
+inline bool write_all(int fd, const char* data, size_t size)
+{
+  while (size > 0) {
+    int written = _write(fd, data, static_cast<unsigned>(min<size_t>(size, 1 << 30)));
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+#else
+inline int open_for_append(const string& path)
+{
+  return open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+}
+inline int open_for_write(const string& path)
+{
+  return open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+}
+inline bool sync(int fd)
+{
+  return fsync(fd) == 0;
+}
+inline bool resize(int fd, uint64_t size)
+{
+  return ftruncate(fd, static_cast<off_t>(size)) == 0;
+}
+// A rename is only durable once the directory that holds the file is synced
+inline bool sync_parent_directory(const string& path)
+{
+  size_t slash = path.find_last_of('/');
+  string dir   = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+  int    fd    = open(dir.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  bool synced = fsync(fd) == 0;
+  close(fd);
+  return synced;
+}
+inline void close_file(int fd)
+{
+  close(fd);
+}
+inline bool write_all(int fd, const char* data, size_t size)
+{
+  while (size > 0) {
+    ssize_t written = write(fd, data, size);
+    if (written <= 0) {
+      return false;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+#endif
+
+/**
+ * @brief Reads a whole file. A missing file reads as empty.
+ */
+inline string read_all(const string& path)
+{
+  ifstream      file(path, ios::binary);
+  ostringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+} // namespace file_io
+
+/**
+ * @brief CRC-32 (the polynomial of zip and Ethernet) of size bytes.
+ *
+ * Reads 4 bytes per step (slicing-by-4): table[k][b] is the CRC of byte b
+ * followed by k zero bytes, so the four lookups of a step are independent.
+ *
+ * @param crc The CRC-32 of the bytes before these, to continue it.
+ */
+uint32_t crc32(const char* data, size_t size, uint32_t crc = 0)
+{
+  static const array<array<uint32_t, 256>, 4> table = [] {
+    array<array<uint32_t, 256>, 4> t{};
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int bit = 0; bit < 8; ++bit) {
+        c = (c & 1) != 0 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      t[0][i] = c;
+    }
+    for (size_t k = 1; k < 4; ++k) {
+      for (size_t i = 0; i < 256; ++i) {
+        t[k][i] = t[0][t[k - 1][i] & 0xFF] ^ (t[k - 1][i] >> 8);
+      }
+    }
+    return t;
+  }();
+
+  const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+  crc               = ~crc;
+  for (; size >= 4; size -= 4, bytes += 4) {
+    crc ^= uint32_t(bytes[0]) | uint32_t(bytes[1]) << 8 | uint32_t(bytes[2]) << 16 | uint32_t(bytes[3]) << 24;
+    crc = table[3][crc & 0xFF] ^ table[2][(crc >> 8) & 0xFF] ^ table[1][(crc >> 16) & 0xFF] ^ table[0][crc >> 24];
+  }
+  for (; size > 0; --size, ++bytes) {
+    crc = table[0][(crc ^ *bytes) & 0xFF] ^ (crc >> 8);
+  }
+  return ~crc;
+}
+
+/**
+ * @brief Appends numbers and strings to a byte string, in little-endian order.
+ */
+class Writer
+{
+public:
+  explicit Writer(string& out) : out_(out)
+  {
+  }
+
+  Writer& u8(uint8_t value)
+  {
+    out_.push_back(static_cast<char>(value));
+    return *this;
+  }
+  Writer& u32(uint32_t value)
+  {
+    for (int shift = 0; shift < 32; shift += 8) {
+      out_.push_back(static_cast<char>(value >> shift));
+    }
+    return *this;
+  }
+  Writer& u64(uint64_t value)
+  {
+    return u32(static_cast<uint32_t>(value)).u32(static_cast<uint32_t>(value >> 32));
+  }
+  Writer& i32(int value)
+  {
+    return u32(static_cast<uint32_t>(value));
+  }
+  Writer& str(const string& value)
+  {
+    u32(static_cast<uint32_t>(value.size()));
+    out_ += value;
+    return *this;
+  }
+
+private:
+  string& out_;
+};
+
+/**
+ * @brief Reads what a Writer wrote. Reading past the end leaves ok() false.
+ */
+class Reader
+{
+public:
+  Reader(const char* data, size_t size) : pos_(data), end_(data + size)
+  {
+  }
+
+  bool ok() const
+  {
+    return ok_;
+  }
+  bool at_end() const
+  {
+    return pos_ == end_;
+  }
+
+  uint8_t u8()
+  {
+    return static_cast<uint8_t>(take(1) ? static_cast<unsigned char>(pos_[-1]) : 0);
+  }
+  uint32_t u32()
+  {
+    if (!take(4)) {
+      return 0;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+      value |= uint32_t(static_cast<unsigned char>(pos_[i - 4])) << (8 * i);
+    }
+    return value;
+  }
+  uint64_t u64()
+  {
+    uint64_t low = u32();
+    return low | uint64_t(u32()) << 32;
+  }
+  int i32()
+  {
+    return static_cast<int>(u32());
+  }
+  string str()
+  {
+    uint32_t size = u32();
+    return take(size) ? string(pos_ - size, size) : string();
+  }
+
+private:
+  bool take(size_t size)
+  {
+    if (!ok_ || static_cast<size_t>(end_ - pos_) < size) {
+      ok_ = false;
+      return false;
+    }
+    pos_ += size;
+    return true;
+  }
+
+  const char* pos_;
+  const char* end_;
+  bool        ok_ = true;
+};
+
+/**
+ * @brief One change to the map: the operations of the menu of maps.cpp.
+ */
+struct Mutation
+{
+  enum class Type : uint8_t
+  {
+    insert = 1, // Inserts or replaces the entry (id, name)
+    modify = 2, // Changes age and address of the first entry with id
+    remove = 3, // Removes the first entry with id
+    clear  = 4
+  };
+
+  Type   type;
+  int    id = 0;
+  string name;
+  int    age = 0;
+  string address;
+
+  void encode(string& out) const
+  {
+    Writer writer(out);
+    writer.u8(static_cast<uint8_t>(type));
+    switch (type) {
+    case Type::insert:
+      writer.i32(id).str(name).i32(age).str(address);
+      break;
+    case Type::modify:
+      writer.i32(id).i32(age).str(address);
+      break;
+    case Type::remove:
+      writer.i32(id);
+      break;
+    case Type::clear:
+      break;
+    }
+  }
+
+  /**
+   * @return bool False if the bytes are not a valid mutation.
+   */
+  bool decode(Reader& reader)
+  {
+    type = static_cast<Type>(reader.u8());
+    switch (type) {
+    case Type::insert:
+      id      = reader.i32();
+      name    = reader.str();
+      age     = reader.i32();
+      address = reader.str();
+      break;
+    case Type::modify:
+      id      = reader.i32();
+      age     = reader.i32();
+      address = reader.str();
+      break;
+    case Type::remove:
+      id = reader.i32();
+      break;
+    case Type::clear:
+      break;
+    default:
+      return false;
+    }
+    return reader.ok() && reader.at_end();
+  }
+
+  /**
+   * @brief Applies the mutation to m, as the menu of maps.cpp does.
+   *
+   * @return bool False if it changed nothing, because no entry has the id.
+   */
+  bool apply(CustomMap& m) const&
+  {
+    switch (type) {
+    case Type::insert:
+      m.insert_or_assign(CustomKey(id, name), CustomValue(age, address));
+      return true;
+    case Type::modify: {
+      auto it = m.find_id(id);
+      if (it == m.end()) {
+        return false;
+      }
+      it->second.age     = age;
+      it->second.address = address;
+      return true;
+    }
+    case Type::remove: {
+      auto it = m.find_id(id);
+      if (it == m.end()) {
+        return false;
+      }
+      m.erase(it);
+      return true;
+    }
+    case Type::clear:
+      m.clear();
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Same, but moves the strings into the map instead of copying them.
+   */
+  bool apply(CustomMap& m) &&
+  {
+    if (type == Type::insert) {
+      m.insert_or_assign(CustomKey(id, move(name)), CustomValue(age, move(address)));
+      return true;
+    }
+    return apply(m);
+  }
+};
+
+/**
+ * @brief How long an operation waits for its record to reach the disk.
+ */
+enum class Durability
+{
+  every_commit, // Each record is written and synced by the operation itself
+  group,        // A background thread syncs records in groups; the operation waits for its group
+  async         // As group, but the operation does not wait, and the thread waits a while to gather more records
+};
+
+/**
+ * @brief Append-only file of numbered records.
+ *
+ * append() may be called from several threads. truncate() must not run at
+ * the same time as append().
+ */
+class WriteAheadLog
+{
+public:
+  /**
+   * @param path        File of the log. Records are added after its contents.
+   * @param next_lsn    Sequence number of the first record appended.
+   * @param async_delay In async mode, longest time a record waits to be
+   *                    written.
+   *
+   * @throws runtime_error If the file cannot be opened.
+   */
+  WriteAheadLog(const string& path, Durability durability, uint64_t next_lsn, chrono::microseconds async_delay)
+    : durability_(durability), async_delay_(async_delay), next_lsn_(next_lsn), durable_lsn_(next_lsn - 1)
+  {
+    fd_ = file_io::open_for_append(path);
+    if (fd_ < 0) {
+      throw runtime_error("Could not open file " + path);
+    }
+    if (durability_ != Durability::every_commit) {
+      flusher_ = thread([this] { flush_loop(); });
+    }
+  }
+
+  WriteAheadLog(const WriteAheadLog&)            = delete;
+  WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+  ~WriteAheadLog()
+  {
+    if (flusher_.joinable()) {
+      {
+        lock_guard<mutex> lock(mutex_);
+        stop_ = true;
+      }
+      wake_.notify_one();
+      flusher_.join(); // Writes what is left first
+    }
+    file_io::close_file(fd_);
+  }
+
+  static constexpr size_t header_size = 16;
+
+  /**
+   * @brief Starts a record in out: room for the header, which the payload
+   * follows. The header bytes are left as they are, seal_record() and
+   * append() write all of them.
+   */
+  static void begin_record(string& out)
+  {
+    out.resize(header_size);
+  }
+
+  /**
+   * @brief Fills in the size of a record and the CRC-32 of its payload. It
+   * needs no lock, so the costly part of the framing stays out of append().
+   */
+  static void seal_record(string& record)
+  {
+    store_u32(&record[0], static_cast<uint32_t>(record.size() - 8));
+    store_u32(&record[4], crc32(record.data() + header_size, record.size() - header_size));
+  }
+
+  /**
+   * @brief Adds a record sealed with seal_record(), after giving it the next
+   * sequence number.
+   *
+   * @return uint64_t The sequence number of the record.
+   * @throws runtime_error If a write to the file failed, now or before.
+   */
+  uint64_t append(string& record)
+  {
+    unique_lock<mutex> lock(mutex_);
+    if (failed_) { // In async mode nobody else would notice
+      throw runtime_error("Could not write to the log");
+    }
+    uint64_t lsn = next_lsn_++;
+
+    // The CRC-32 of the payload goes on with the sequence number
+    store_u32(&record[8], static_cast<uint32_t>(lsn));
+    store_u32(&record[12], static_cast<uint32_t>(lsn >> 32));
+    store_u32(&record[4], crc32(record.data() + 8, 8, Reader(record.data() + 4, 4).u32()));
+    bool empty = buffer_.empty();
+    buffer_ += record;
+    size_bytes_.fetch_add(record.size(), memory_order_relaxed);
+
+    if (durability_ == Durability::every_commit) {
+      bool written = file_io::write_all(fd_, buffer_.data(), buffer_.size()) && file_io::sync(fd_);
+      buffer_.clear();
+      if (!written) {
+        throw runtime_error("Could not write to the log");
+      }
+      durable_lsn_ = lsn;
+    }
+    else if (empty) { // Otherwise the flusher was already woken up for the records before
+      wake_.notify_one();
+    }
+    return lsn;
+  }
+
+  /**
+   * @brief Waits until the record lsn, and every one before it, is on the
+   * disk.
+   *
+   * @throws runtime_error If a write to the file failed.
+   */
+  void sync(uint64_t lsn)
+  {
+    unique_lock<mutex> lock(mutex_);
+    if (durable_lsn_ < lsn) {
+      ++waiters_;
+      wake_.notify_one(); // The flusher stops gathering records for someone waiting
+      durable_.wait(lock, [&] { return durable_lsn_ >= lsn || failed_; });
+      --waiters_;
+    }
+    if (failed_) {
+      throw runtime_error("Could not write to the log");
+    }
+  }
+
+  /**
+   * @brief Waits until every record appended so far is on the disk.
+   */
+  void flush()
+  {
+    uint64_t last;
+    {
+      lock_guard<mutex> lock(mutex_);
+      last = next_lsn_ - 1;
+    }
+    sync(last);
+  }
+
+  /**
+   * @brief Empties the log, after waiting for the records in flight. Used
+   * once the records are saved in a checkpoint.
+   */
+  void truncate()
+  {
+    flush();
+    lock_guard<mutex> lock(mutex_);
+    if (!file_io::resize(fd_, 0) || !file_io::sync(fd_)) {
+      throw runtime_error("Could not truncate the log");
+    }
+    size_bytes_.store(0, memory_order_relaxed);
+  }
+
+  /**
+   * @brief Bytes appended since the log was opened or last truncated.
+   */
+  uint64_t size_bytes() const
+  {
+    return size_bytes_.load(memory_order_relaxed); // Read after every commit, so without the lock
+  }
+
+  uint64_t last_lsn() const
+  {
+    lock_guard<mutex> lock(mutex_);
+    return next_lsn_ - 1;
+  }
+
+  /**
+   * @brief Calls f(lsn, payload) for every record of the log in data, in
+   * order, up to the first one that is cut short or damaged.
+   *
+   * @return size_t The number of bytes of whole, valid records at the start of
+   * data.
+   */
+  template <typename F>
+  static size_t replay(const string& data, F f)
+  {
+    size_t pos = 0;
+    while (data.size() - pos >= 16) {
+      Reader   header(data.data() + pos, 8);
+      uint32_t size = header.u32();
+      uint32_t crc  = header.u32();
+      if (size < 8 || data.size() - pos - 8 < size || crc32(data.data() + pos + 8, 8, crc32(data.data() + pos + 16, size - 8)) != crc) {
+        break;
+      }
+      Reader   body(data.data() + pos + 8, 8);
+      uint64_t lsn = body.u64();
+      f(lsn, string(data, pos + 16, size - 8));
+      pos += 8 + size;
+    }
+    return pos;
+  }
+
+private:
+  static void store_u32(char* out, uint32_t value)
+  {
+    for (int i = 0; i < 4; ++i) {
+      out[i] = static_cast<char>(value >> (8 * i));
+    }
+  }
+
+  /**
+   * @brief Background thread of group commit: writes and syncs everything
+   * appended while the previous sync ran, then wakes up its waiters.
+   */
+  void flush_loop()
+  {
+    unique_lock<mutex> lock(mutex_);
+    while (true) {
+      wake_.wait(lock, [&] { return stop_ || !buffer_.empty(); });
+      if (buffer_.empty()) {
+        return; // Stopping, and nothing left to write
+      }
+      if (durability_ == Durability::async) {
+        wake_.wait_for(lock, async_delay_, [&] { return stop_ || waiters_ > 0 || buffer_.size() >= async_buffer_limit; });
+      }
+      uint64_t last = next_lsn_ - 1;
+      swap(batch_, buffer_); // buffer_ gets the capacity of the last batch, and does not grow again
+
+      lock.unlock();
+      bool written = file_io::write_all(fd_, batch_.data(), batch_.size()) && file_io::sync(fd_);
+      batch_.clear();
+      lock.lock();
+
+      if (written) {
+        durable_lsn_ = last;
+      }
+      else {
+        failed_ = true;
+      }
+      durable_.notify_all();
+    }
+  }
+
+  static constexpr size_t async_buffer_limit = 1 << 20; // Written without waiting for async_delay
+
+  Durability           durability_;
+  chrono::microseconds async_delay_;
+  int                  fd_ = -1;
+  mutable mutex        mutex_;
+  condition_variable   wake_;    // The flusher waits here for records
+  condition_variable   durable_; // Operations wait here for their sync
+  string               buffer_;  // Records not written yet
+  string               batch_;   // Records being written by the flusher
+  uint64_t             next_lsn_;
+  uint64_t             durable_lsn_;
+  atomic<uint64_t>     size_bytes_{0};
+  size_t               waiters_ = 0; // Threads in sync()
+  bool                 failed_  = false;
+  bool                 stop_    = false;
+  thread               flusher_;
+};
+
+/**
+ * @brief Settings of a DurableMap.
+ */
+struct DurableOptions
+{
+  Durability           durability       = Durability::group;
+  uint64_t             checkpoint_bytes = 64 << 20; // A log larger than this is folded into a checkpoint
+  chrono::microseconds async_delay{1000};           // See WriteAheadLog
+};
+
+/**
+ * @brief What the recovery of a DurableMap found.
+ */
+struct RecoveryStats
+{
+  size_t checkpoint_entries = 0;
+  size_t replayed_records   = 0;
+  size_t discarded_bytes    = 0; // Damaged or incomplete tail of the log
+  double milliseconds       = 0;
+};
+
+/**
+ * @brief CustomMap whose changes survive the end of the program.
+ *
+ * Uses the files base_path + ".log" and base_path + ".checkpoint". The
+ * operations can be called from several threads: changes to the map are
+ * serialized, and waiting for the disk is not.
+ */
+class DurableMap
+{
+public:
+  /**
+   * @brief Rebuilds the map from the files at base_path, if they exist.
+   *
+   * @throws runtime_error If a file cannot be read or written, or the
+   * checkpoint is damaged.
+   */
+  explicit DurableMap(const string& base_path, DurableOptions options = DurableOptions())
+    : options_(options), log_path_(base_path + ".log"), checkpoint_path_(base_path + ".checkpoint")
+  {
+    auto     start      = chrono::steady_clock::now();
+    uint64_t last_lsn   = load_checkpoint();
+    string   log        = file_io::read_all(log_path_);
+    size_t   valid_size = WriteAheadLog::replay(log, [&](uint64_t lsn, const string& payload) {
+      if (lsn <= last_lsn) {
+        return; // Already in the checkpoint
+      }
+      Reader   reader(payload.data(), payload.size());
+      Mutation mutation;
+      if (mutation.decode(reader)) {
+        mutation.apply(map_);
+        ++stats_.replayed_records;
+      }
+      last_lsn = lsn;
+    });
+
+    stats_.discarded_bytes = log.size() - valid_size;
+    if (stats_.discarded_bytes != 0) { // Cut the damaged tail, so new records follow valid ones
+      int fd = file_io::open_for_append(log_path_);
+      if (fd < 0 || !file_io::resize(fd, valid_size) || !file_io::sync(fd)) {
+        throw runtime_error("Could not repair file " + log_path_);
+      }
+      file_io::close_file(fd);
+    }
+    log_ = make_unique<WriteAheadLog>(log_path_, options_.durability, last_lsn + 1, options_.async_delay);
+    stats_.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+  }
+
+  const RecoveryStats& recovery() const
+  {
+    return stats_;
+  }
+
+  void insert(CustomKey key, CustomValue value)
+  {
+    Mutation mutation{Mutation::Type::insert, key.id, move(key.name), value.age, move(value.address)};
+    commit(move(mutation));
+  }
+
+  /**
+   * @return bool False if no entry has the id.
+   */
+  bool modify(int id, int age, string address)
+  {
+    return commit(Mutation{Mutation::Type::modify, id, "", age, move(address)});
+  }
+
+  /**
+   * @return bool False if no entry has the id.
+   */
+  bool remove(int id)
+  {
+    return commit(Mutation{Mutation::Type::remove, id, "", 0, ""});
+  }
+
+  void clear()
+  {
+    commit(Mutation{Mutation::Type::clear, 0, "", 0, ""});
+  }
+
+  /**
+   * @brief Calls f(map) with the map locked against changes.
+   */
+  template <typename F>
+  void read(F f) const
+  {
+    lock_guard<mutex> lock(mutex_);
+    f(static_cast<const CustomMap&>(map_));
+  }
+
+  /**
+   * @brief Saves the whole map in the checkpoint file and empties the log.
+   */
+  void checkpoint()
+  {
+    lock_guard<mutex> lock(mutex_);
+    checkpoint_locked();
+  }
+
+private:
+  /**
+   * @brief Logs mutation and applies it to the map. Then, unless the map is in
+   * async mode, waits for the record to be on the disk.
+   *
+   * @return bool False if the mutation had nothing to change, in which case
+   * it is not logged.
+   */
+  bool commit(Mutation&& mutation)
+  {
+    // Encoded and checksummed before taking the locks, which then only cover
+    // the copy of the record into the log
+    thread_local string record;
+    WriteAheadLog::begin_record(record);
+    mutation.encode(record);
+    WriteAheadLog::seal_record(record);
+
+    uint64_t lsn;
+    {
+      lock_guard<mutex> lock(mutex_);
+      bool              needs_entry = mutation.type == Mutation::Type::modify || mutation.type == Mutation::Type::remove;
+      if (needs_entry && map_.find_id(mutation.id) == map_.end()) {
+        return false;
+      }
+      lsn = log_->append(record); // Logged before the map changes
+      move(mutation).apply(map_);
+      if (log_->size_bytes() > options_.checkpoint_bytes) {
+        checkpoint_locked();
+      }
+    }
+    if (options_.durability != Durability::async) {
+      log_->sync(lsn);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Writes the checkpoint: magic, last sequence number included,
+   * number of entries, CRC-32 of the entries, and the entries as insert
+   * mutations. It is written to a temporary file and renamed, so the old
+   * checkpoint stays valid until the new one is complete.
+   */
+  void checkpoint_locked()
+  {
+    string body;
+    for (const auto& [key, value] : map_) {
+      Mutation{Mutation::Type::insert, key.id, key.name, value.age, value.address}.encode(body);
+    }
+    uint64_t lsn = log_->last_lsn();
+
+    string file(checkpoint_magic);
+    Writer(file).u64(lsn).u64(map_.size()).u32(crc32(body.data(), body.size()));
+    file += body;
+
+    string temporary = checkpoint_path_ + ".tmp";
+    int    fd        = file_io::open_for_write(temporary);
+    bool   written   = fd >= 0 && file_io::write_all(fd, file.data(), file.size()) && file_io::sync(fd);
+    if (fd >= 0) {
+      file_io::close_file(fd);
+    }
+    // The rename must be on the disk before the log is emptied, or a crash
+    // could keep the empty log and the old checkpoint
+    if (!written || !replace_file(temporary, checkpoint_path_) || !file_io::sync_parent_directory(checkpoint_path_)) {
+      throw runtime_error("Could not write file " + checkpoint_path_);
+    }
+    log_->truncate(); // Only once the checkpoint is complete
+  }
+
+  /**
+   * @brief Loads the checkpoint into the map, if there is one.
+   *
+   * @return uint64_t The sequence number of the last record it includes.
+   */
+  uint64_t load_checkpoint()
+  {
+    string data = file_io::read_all(checkpoint_path_);
+    if (data.empty()) {
+      return 0;
+    }
+    size_t   magic_size = min(sizeof(checkpoint_magic) - 1, data.size());
+    Reader   header(data.data() + magic_size, data.size() - magic_size);
+    uint64_t lsn   = header.u64();
+    uint64_t count = header.u64();
+    uint32_t crc   = header.u32();
+    size_t   start = magic_size + 20;
+    if (data.compare(0, magic_size, checkpoint_magic) != 0 || !header.ok() || crc32(data.data() + start, data.size() - start) != crc) {
+      throw runtime_error("Damaged checkpoint " + checkpoint_path_);
+    }
+
+    vector<pair<CustomKey, CustomValue>> entries;
+    entries.reserve(count);
+    Reader reader(data.data() + start, data.size() - start);
+    while (!reader.at_end()) {
+      Mutation mutation;
+      mutation.type    = static_cast<Mutation::Type>(reader.u8());
+      mutation.id      = reader.i32();
+      mutation.name    = reader.str();
+      mutation.age     = reader.i32();
+      mutation.address = reader.str();
+      if (!reader.ok() || mutation.type != Mutation::Type::insert) {
+        throw runtime_error("Damaged checkpoint " + checkpoint_path_);
+      }
+      entries.emplace_back(CustomKey(mutation.id, move(mutation.name)), CustomValue(mutation.age, move(mutation.address)));
+    }
+    stats_.checkpoint_entries = entries.size();
+    map_.bulk_load(move(entries)); // Already sorted: built in linear time
+    return lsn;
+  }
+
+  static bool replace_file(const string& from, const string& to)
+  {
+#ifdef _WIN32
+    // rename does not replace files on Windows, and removing the old one first
+    // would leave no checkpoint if the program stopped in between
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(from.c_str(), to.c_str()) == 0;
+#endif
+  }
+
+  static constexpr char checkpoint_magic[] = "CKVCHKP1";
+
+  DurableOptions            options_;
+  string                    log_path_;
+  string                    checkpoint_path_;
+  mutable mutex             mutex_;
+  CustomMap                 map_;
+  unique_ptr<WriteAheadLog> log_;
+  RecoveryStats             stats_;
+};
+
+/**
+ * @brief Prints the entries of the map, in the same format as print_map() in
+ * maps.cpp.
+ */
+void print_map(const CustomMap& m)
+{
+  for (const auto& [key, value] : m) {
+    cout << "Name: " << key.name << " ID(" << key.id << ") -> Age: " << value.age << ", Address: " << value.address << '\n';
+  }
+}
+
+/**
+ * @brief Deletes the files of a DurableMap.
+ */
+void remove_files(const string& base_path)
+{
+  remove((base_path + ".log").c_str());
+  remove((base_path + ".checkpoint").c_str());
+}
+
+/**
+ * @brief Same operations as the menu of maps.cpp, then a restart that
+ * recovers them from the log.
+ */
+void basic_write_ahead_log(const string& base_path)
+{
+  remove_files(base_path);
+  {
+    DurableMap m(base_path);
+    // Predefine
+    m.insert(CustomKey(1, "Alice"), CustomValue(25, "123 Main St"));
+    m.insert(CustomKey(2, "Bob"), CustomValue(30, "456 Elm St"));
+    m.insert(CustomKey(3, "Charlie"), CustomValue(35, "789 Oak St"));
+    m.modify(2, 31, "1 New St");
+    m.remove(3);
+  } // The program ends here
+
+  DurableMap m(base_path);
+  cout << "Recovered " << m.recovery().replayed_records << " records:\n";
+  m.read(print_map);
+}
+
+/**
+ * @brief Runs f once and returns the elapsed time in milliseconds.
+ */
+template <typename F>
+double time_ms(F&& f)
+{
+  auto start = chrono::steady_clock::now();
+  f();
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Inserts ops entries from num_threads threads at once.
+ *
+ * @return double Elapsed microseconds divided by the number of operations.
+ */
+double insert_cost(DurableMap& m, size_t ops, unsigned num_threads)
+{
+  vector<thread> threads;
+  double         ms = time_ms([&] {
+    for (unsigned t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&m, ops, num_threads, t] {
+        for (size_t i = t; i < ops; i += num_threads) {
+          m.insert(CustomKey(static_cast<int>(i), "name-" + to_string(i % 1000)), CustomValue(static_cast<int>(i % 100), "Street"));
+        }
+      });
+    }
+    for (auto& th : threads) {
+      th.join();
+    }
+  });
+  return ms * 1000 / static_cast<double>(ops);
+}
+
+/**
+ * @brief Measures the cost of logging, then checks that recovery after a
+ * crash gives the map that was written, with several checkpoints and a
+ * last record that is cut short or fails its CRC.
+ *
+ * @return bool True if the recovered map is the expected one.
+ */
+bool benchmark(size_t n, const string& base_path)
+{
+  cout << "\nBenchmark with " << n << " operations" << '\n';
+
+  // Memory only and async logging are the closest settings. Their runs are
+  // alternated, and each time is the best of them, so that a moment the
+  // machine is busy with other work does not slow down only one of the two
+  double plain_us = numeric_limits<double>::max();
+  double async_us = numeric_limits<double>::max();
+  for (int run = 0; run < 5; ++run) {
+    {
+      CustomMap plain;
+      plain_us = min(plain_us, time_ms([&] {
+                   for (size_t i = 0; i < n; ++i) {
+                     plain.insert_or_assign(CustomKey(static_cast<int>(i), "name-" + to_string(i % 1000)), CustomValue(static_cast<int>(i % 100), "Street"));
+                   }
+                 }) * 1000 / static_cast<double>(n));
+    }
+    remove_files(base_path);
+    DurableMap m(base_path, DurableOptions{Durability::async, uint64_t(1) << 40});
+    async_us = min(async_us, insert_cost(m, n, 1));
+  }
+  cout << "insert, memory only:            " << plain_us << " us\n";
+
+  struct Setting
+  {
+    const char* name;
+    Durability  durability;
+    unsigned    threads;
+    size_t      ops;
+  };
+  for (const Setting& setting : {Setting{"fsync each record, 1 thread: ", Durability::every_commit, 1, max<size_t>(1, n / 20)},
+                                 Setting{"group commit, 1 thread:      ", Durability::group, 1, max<size_t>(1, n / 20)},
+                                 Setting{"group commit, 8 threads:     ", Durability::group, 8, max<size_t>(8, n / 5)}}) {
+    remove_files(base_path);
+    DurableMap m(base_path, DurableOptions{setting.durability, uint64_t(1) << 40});
+    cout << "insert, " << setting.name << "  " << insert_cost(m, setting.ops, setting.threads) << " us\n";
+  }
+  cout << "insert, async, 1 thread:               " << async_us << " us (" << async_us / plain_us << " times memory only)\n";
+
+  // Crash test: random operations with a small checkpoint limit
+  remove_files(base_path);
+  CustomMap expected;
+  {
+    DurableMap m(base_path, DurableOptions{Durability::async, 256 * 1024});
+    mt19937    rng(42);
+    for (size_t i = 0; i < n; ++i) {
+      int      id = static_cast<int>(rng() % (n / 4 + 1));
+      Mutation mutation{Mutation::Type::insert, id, "name-" + to_string(rng() % 100), static_cast<int>(i % 100), "Street " + to_string(i)};
+      switch (rng() % 10) {
+      case 0:
+        mutation.type = Mutation::Type::remove;
+        break;
+      case 1:
+        mutation.type = Mutation::Type::modify;
+        break;
+      default:
+        break;
+      }
+      if (i == n / 2) {
+        mutation.type = Mutation::Type::clear;
+      }
+      mutation.apply(expected);
+      switch (mutation.type) {
+      case Mutation::Type::insert:
+        m.insert(CustomKey(mutation.id, mutation.name), CustomValue(mutation.age, mutation.address));
+        break;
+      case Mutation::Type::modify:
+        m.modify(mutation.id, mutation.age, mutation.address);
+        break;
+      case Mutation::Type::remove:
+        m.remove(mutation.id);
+        break;
+      case Mutation::Type::clear:
+        m.clear();
+        break;
+      }
+    }
+  }
+
+  // Appends tail to the log, as a crash in the middle of a write would leave
+  // it, and checks that recovery discards it and nothing else
+  auto recover_after = [&](const string& tail) {
+    {
+      ofstream log(base_path + ".log", ios::binary | ios::app);
+      log.write(tail.data(), static_cast<streamsize>(tail.size()));
+    }
+    DurableMap  recovered(base_path);
+    const auto& stats = recovered.recovery();
+    cout << "recovery: " << stats.milliseconds << " ms, " << stats.checkpoint_entries << " entries from the checkpoint, " << stats.replayed_records
+         << " records replayed, " << stats.discarded_bytes << " damaged bytes discarded\n";
+
+    bool same = stats.discarded_bytes == tail.size();
+    recovered.read([&](const CustomMap& m) {
+      same = same && m.size() == expected.size();
+      auto it = expected.begin();
+      for (const auto& [key, value] : m) {
+        same = same && key.id == it->first.id && key.name == it->first.name && value.age == it->second.age && value.address == it->second.address;
+        ++it;
+      }
+    });
+    return same;
+  };
+
+  // A record the crash cut in half: shorter than its header
+  bool same = recover_after(string("\x40\x00\x00\x00\x12\x34", 6));
+
+  // A whole record whose payload was not fully written: its CRC does not match.
+  // Replaying it would insert a key that is not in the expected map
+  string   payload;
+  string   damaged;
+  uint64_t lsn = numeric_limits<uint64_t>::max();
+  Mutation{Mutation::Type::insert, -1, "torn", 0, "Nowhere"}.encode(payload);
+  string lsn_bytes;
+  Writer(lsn_bytes).u64(lsn);
+  uint32_t crc = crc32(lsn_bytes.data(), lsn_bytes.size(), crc32(payload.data(), payload.size()));
+  Writer(damaged).u32(static_cast<uint32_t>(8 + payload.size())).u32(crc ^ 1).u64(lsn);
+  damaged += payload;
+  same = recover_after(damaged) && same;
+  return same;
+}
+
+/**
+ * @brief Entry point of the program.
+ *
+ * The number of operations and the path of the files, without extension, can
+ * be passed as the first and second arguments.
+ *
+ * @return int Returns 0 if the recovered map is the expected one.
+ */
+int main(int argc, char* argv[])
+{
+  size_t n         = argc > 1 ? strtoull(argv[1], nullptr, 10) : 200000;
+  string base_path = argc > 2 ? argv[2] : "durable_map";
+
+  try {
+    basic_write_ahead_log(base_path);
+    bool ok = benchmark(n, base_path);
+    cout << "Same results: " << (ok ? "yes" : "no") << '\n';
+    remove_files(base_path);
+    return ok ? 0 : 1;
+  }
+  catch (const exception& e) {
+    cout << "Error: " << e.what() << '\n';
+    return 1;
+  }
+}